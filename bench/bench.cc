@@ -0,0 +1,464 @@
+#include <iostream>
+#include <fstream> // baseline files
+#include <sstream> // ostringstream
+#include <iomanip> // setw, setprecision
+#include <cstdlib> // exit(), atoi(), atof()
+#include <cstring> // strcmp()
+#include <cmath> // fabs()
+#include <string> // string
+#include <vector> // vector
+#include <map> // map
+#include <memory> // shared_ptr
+#include <chrono> // measuring time
+#include <algorithm> // sort, min_element
+#include <functional> // function
+#include <thread> // hardware_concurrency
+#include "../src/data.h"
+#include "../src/tsp.h"
+#include "../src/node.h"
+#include "../src/hungarian.h"
+#include "../src/bounding.h"
+#include "../src/kdtree.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * One microbenchmark: `setup` and `teardown` run around every
+ * call of `run`, only the latter is timed
+ */
+typedef struct s_bench {
+	std::string name;
+	std::function<void ()> setup;
+	std::function<void ()> run;
+	std::function<void ()> teardown;
+} Bench;
+
+typedef struct s_bench_result {
+	std::string name;
+
+	/**
+	 * Seconds per call of `run`: median and median absolute
+	 * deviation over the samples, and the fastest sample
+	 */
+	double median;
+	double mad;
+	double min;
+} BenchResult;
+
+typedef struct s_bench_options {
+	std::string instances;
+	std::string filter;
+	std::string save;
+	std::string baseline;
+
+	/**
+	 * Samples taken after one warm-up sample, each one repeats the
+	 * benchmark for at least `min_time` seconds
+	 */
+	int samples;
+	double min_time;
+} BenchOptions;
+
+/**
+ * Instance shared by the benchmarks that need an already built
+ * TSPInfo, loaded the first time one of them runs
+ */
+typedef struct s_bench_instance {
+	std::string path;
+	bool loaded;
+	TSPInfo tsp_info;
+} BenchInstance;
+
+static void bench_usage () {
+	std::cout << " ./bench.out [options]" << std::endl
+		<< "  --instances DIR   directory with the TSPLIB files (default instances)" << std::endl
+		<< "  --filter TEXT     only run benchmarks whose name contains TEXT" << std::endl
+		<< "  --samples N       samples per benchmark (default 15)" << std::endl
+		<< "  --min-time MS     minimum length of a sample (default 20)" << std::endl
+		<< "  --save FILE       save the medians as a baseline" << std::endl
+		<< "  --baseline FILE   compare the medians against a saved baseline" << std::endl;
+}
+
+static void bench_parse (BenchOptions &options, int argc, char **argv) {
+	options.instances = "instances";
+	options.samples = 15;
+	options.min_time = 0.020;
+
+	for (int i = 1; i < argc; ++i) {
+		const char *arg = argv[i];
+
+		if (strcmp(arg, "--help") == 0) {
+			bench_usage();
+			exit(EXIT_SUCCESS);
+		}
+
+		if (i + 1 >= argc) {
+			std::cout << "Missing value for " << arg << std::endl;
+			bench_usage();
+			exit(EXIT_FAILURE);
+		}
+
+		const char *value = argv[++i];
+
+		if (strcmp(arg, "--instances") == 0)
+			options.instances = value;
+		else if (strcmp(arg, "--filter") == 0)
+			options.filter = value;
+		else if (strcmp(arg, "--samples") == 0)
+			options.samples = atoi(value) > 0 ? atoi(value) : 1;
+		else if (strcmp(arg, "--min-time") == 0)
+			options.min_time = atof(value) / 1000;
+		else if (strcmp(arg, "--save") == 0)
+			options.save = value;
+		else if (strcmp(arg, "--baseline") == 0)
+			options.baseline = value;
+		else {
+			std::cout << "Unknown option: " << arg << std::endl;
+			bench_usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+static double bench_median (std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+
+	size_t half = values.size() / 2;
+	if (values.size() % 2)
+		return values[half];
+
+	return (values[half -1] + values[half]) / 2;
+}
+
+/**
+ * Average seconds per call of `bench.run` over a sample of
+ * at least `min_time` seconds
+ */
+static double bench_sample (Bench &bench, double min_time) {
+	double timed = 0;
+	long calls = 0;
+
+	while (timed < min_time || calls == 0) {
+		if (bench.setup)
+			bench.setup();
+
+		Clock::time_point start = Clock::now();
+		bench.run();
+		timed += std::chrono::duration<double>(Clock::now() - start).count();
+		++calls;
+
+		if (bench.teardown)
+			bench.teardown();
+	}
+
+	return timed / calls;
+}
+
+static BenchResult bench_measure (Bench &bench, BenchOptions &options) {
+	// warm-up: caches, page faults and the allocator
+	bench_sample(bench, options.min_time);
+
+	std::vector<double> samples;
+	for (int i = 0; i < options.samples; ++i) {
+		samples.push_back(bench_sample(bench, options.min_time));
+	}
+
+	BenchResult result;
+	result.name = bench.name;
+	result.median = bench_median(samples);
+	result.min = *std::min_element(samples.begin(), samples.end());
+
+	std::vector<double> deviations;
+	for (size_t i = 0; i < samples.size(); ++i) {
+		deviations.push_back(std::fabs(samples[i] - result.median));
+	}
+	result.mad = bench_median(deviations);
+
+	return result;
+}
+
+static std::string bench_time (double seconds) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(2);
+
+	if (seconds < 1e-6)
+		out << seconds * 1e9 << " ns";
+	else if (seconds < 1e-3)
+		out << seconds * 1e6 << " us";
+	else if (seconds < 1)
+		out << seconds * 1e3 << " ms";
+	else
+		out << seconds << " s";
+
+	return out.str();
+}
+
+static std::map<std::string, double> bench_read_baseline (const std::string &path) {
+	std::map<std::string, double> baseline;
+	std::ifstream in(path, std::ios::in);
+
+	if (!in) {
+		std::cout << "Baseline " << path << " not found" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	std::string name;
+	double median;
+	while (in >> name >> median) {
+		baseline[name] = median;
+	}
+
+	return baseline;
+}
+
+static void bench_write_baseline (const std::string &path, std::vector<BenchResult> &results) {
+	std::ofstream out(path, std::ios::out | std::ios::trunc);
+	out << std::setprecision(17);
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		out << results[i].name << " " << results[i].median << "\n";
+	}
+}
+
+static void bench_load (BenchInstance &instance) {
+	if (instance.loaded)
+		return;
+
+	char *argv[] = { (char *) "bench", (char *) instance.path.c_str() };
+	tsp_init(instance.tsp_info, 2, argv, std::max(1u, std::thread::hardware_concurrency()));
+	instance.tsp_info.upper_bound = INFINITE;
+	instance.tsp_info.bounding = BOUNDING_AP;
+	instance.loaded = true;
+}
+
+static void bench_cost_row (void *ctx, int row, double *out) {
+	TSPInfo *tsp_info = (TSPInfo *) ctx;
+	tsp_info->cost_overlay.getRow(*tsp_info->cost_matrix, row, out);
+}
+
+/**
+ * Data::readData, one instance per edge weight format, and
+ * tsp_init on top of it
+ */
+static void bench_add_readers (std::vector<Bench> &benches, const std::string &dir) {
+	const char *formats[][2] = {
+		{ "EUC_2D", "kroA200" },
+		{ "CEIL_2D", "dsj1000" },
+		{ "GEO", "gr202" },
+		{ "ATT", "att532" },
+		{ "FULL_MATRIX", "swiss42" },
+		{ "UPPER_ROW", "brg180" },
+		{ "UPPER_DIAG_ROW", "si535" },
+		{ "LOWER_DIAG_ROW", "pa561" },
+	};
+
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+		std::string path = dir + formats[f][1] + ".tsp";
+		std::shared_ptr<Data *> data (new Data *(NULL));
+
+		Bench bench;
+		bench.name = std::string("readData/") + formats[f][0] + "/" + formats[f][1];
+		bench.setup = [data, path] () {
+			*data = new Data(2, (char *) path.c_str());
+		};
+		bench.run = [data] () {
+			(*data)->readData();
+		};
+		bench.teardown = [data] () {
+			delete *data;
+		};
+		benches.push_back(bench);
+	}
+
+	std::string path = dir + "kroA200.tsp";
+	std::shared_ptr<TSPInfo> tsp_info (new TSPInfo);
+
+	Bench bench;
+	bench.name = "tsp_init/kroA200";
+	bench.run = [tsp_info, path] () {
+		char *argv[] = { (char *) "bench", (char *) path.c_str() };
+		tsp_init(*tsp_info, 2, argv, std::max(1u, std::thread::hardware_concurrency()));
+	};
+	bench.teardown = [tsp_info] () {
+		tsp_free(*tsp_info);
+	};
+	benches.push_back(bench);
+}
+
+/**
+ * The solver and the node evaluation on the root of `name`
+ */
+static void bench_add_solver (std::vector<Bench> &benches, const std::string &dir, const std::string &name) {
+	std::shared_ptr<BenchInstance> instance (new BenchInstance);
+	instance->path = dir + name + ".tsp";
+	instance->loaded = false;
+
+	std::shared_ptr<hungarian_problem_t> problem (new hungarian_problem_t);
+	std::shared_ptr<Node> node (new Node);
+
+	std::function<void ()> init = [instance, problem] () {
+		bench_load(*instance);
+		TSPInfo &tsp_info = instance->tsp_info;
+		hungarian_init_rows(problem.get(), bench_cost_row, &tsp_info,
+			tsp_info.dimension, tsp_info.dimension, HUNGARIAN_MODE_MINIMIZE_COST);
+	};
+	std::function<void ()> release = [problem] () {
+		hungarian_free(problem.get());
+	};
+
+	Bench init_bench;
+	init_bench.name = "hungarian_init/" + name;
+	init_bench.setup = [instance] () {
+		bench_load(*instance);
+	};
+	init_bench.run = init;
+	init_bench.teardown = release;
+	benches.push_back(init_bench);
+
+	Bench solve_bench;
+	solve_bench.name = "hungarian_solve/" + name;
+	solve_bench.setup = init;
+	solve_bench.run = [problem] () {
+		hungarian_solve(problem.get());
+	};
+	solve_bench.teardown = release;
+	benches.push_back(solve_bench);
+
+	Bench subtours_bench;
+	subtours_bench.name = "node_get_subtours_assignment/" + name;
+	subtours_bench.setup = [init, problem, node] () {
+		init();
+		hungarian_solve(problem.get());
+		node->subtours.clear();
+	};
+	subtours_bench.run = [problem, node, instance] () {
+		node_get_subtours_assignment(*node, problem->assignment, instance->tsp_info.dimension);
+	};
+	subtours_bench.teardown = release;
+	benches.push_back(subtours_bench);
+
+	Bench calculate_bench;
+	calculate_bench.name = "node_calculate_solution/" + name;
+	calculate_bench.setup = [instance, node] () {
+		bench_load(*instance);
+		*node = Node();
+	};
+	calculate_bench.run = [instance, node] () {
+		node_calculate_solution(*node, instance->tsp_info, NODE_NO_CUTOFF);
+	};
+	benches.push_back(calculate_bench);
+}
+
+/**
+ * Construction of the spatial index and of the neighbour lists
+ * from the coordinates of `name`, which is never turned into a
+ * distance matrix
+ */
+static void bench_add_spatial (std::vector<Bench> &benches, const std::string &dir, const std::string &name) {
+	std::shared_ptr<KdTree> tree (new KdTree);
+	std::shared_ptr< std::vector<double> > x (new std::vector<double>);
+	std::shared_ptr< std::vector<double> > y (new std::vector<double>);
+	std::string path = dir + name + ".tsp";
+
+	std::function<void ()> load = [path, x, y] () {
+		if (x->size())
+			return;
+
+		Data data(2, (char *) path.c_str());
+		data.readCoordinates();
+		for (int i = 0; i < data.getDimension(); ++i) {
+			x->push_back(data.getXCoord(i));
+			y->push_back(data.getYCoord(i));
+		}
+	};
+
+	int threads = std::max(1u, std::thread::hardware_concurrency());
+
+	Bench build_bench;
+	build_bench.name = "kdtree_build/" + name;
+	build_bench.setup = load;
+	build_bench.run = [tree, x, y, threads] () {
+		kdtree_build(*tree, x->data(), y->data(), x->size(), threads);
+	};
+	benches.push_back(build_bench);
+
+	std::shared_ptr< std::vector<int> > lists (new std::vector<int>);
+
+	Bench lists_bench;
+	lists_bench.name = "kdtree_neighbour_lists/" + name;
+	lists_bench.setup = [load, tree, x, y, threads] () {
+		load();
+		kdtree_build(*tree, x->data(), y->data(), x->size(), threads);
+	};
+	lists_bench.run = [tree, lists, threads] () {
+		kdtree_neighbour_lists(*tree, TSP_NEIGHBOURS, *lists, threads);
+	};
+	benches.push_back(lists_bench);
+}
+
+int main (int argc, char **argv) {
+	BenchOptions options;
+	bench_parse(options, argc, argv);
+
+	std::string dir = options.instances + "/";
+	std::vector<Bench> benches;
+
+	bench_add_readers(benches, dir);
+
+	const char *sizes[] = { "gr17", "eil51", "kroA100", "kroA200", "pcb442", "rat783" };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		bench_add_solver(benches, dir, sizes[s]);
+	}
+
+	const char *spatial[] = { "kroA200", "pla33810", "pla85900" };
+	for (size_t s = 0; s < sizeof(spatial) / sizeof(spatial[0]); ++s) {
+		bench_add_spatial(benches, dir, spatial[s]);
+	}
+
+	std::map<std::string, double> baseline;
+	if (!options.baseline.empty())
+		baseline = bench_read_baseline(options.baseline);
+
+	std::cout << std::left << std::setw(44) << "benchmark"
+		<< std::right << std::setw(12) << "median"
+		<< std::setw(8) << "mad"
+		<< std::setw(12) << "min";
+	if (baseline.size())
+		std::cout << std::setw(12) << "baseline" << std::setw(9) << "change";
+	std::cout << std::endl;
+
+	std::vector<BenchResult> results;
+
+	for (size_t b = 0; b < benches.size(); ++b) {
+		if (!options.filter.empty() && benches[b].name.find(options.filter) == std::string::npos)
+			continue;
+
+		BenchResult result = bench_measure(benches[b], options);
+		results.push_back(result);
+
+		std::cout << std::left << std::setw(44) << result.name
+			<< std::right << std::setw(12) << bench_time(result.median)
+			<< std::setw(7) << std::fixed << std::setprecision(1)
+			<< 100 * result.mad / result.median << "%"
+			<< std::setw(12) << bench_time(result.min);
+
+		if (baseline.count(result.name)) {
+			double before = baseline[result.name];
+			double change = 100 * (result.median - before) / before;
+
+			std::cout << std::setw(12) << bench_time(before)
+				<< std::setw(8) << std::showpos << change << std::noshowpos << "%";
+
+			// changes within three deviations are reported as noise
+			if (std::fabs(result.median - before) <= 3 * result.mad)
+				std::cout << " ~";
+		}
+
+		std::cout << std::endl;
+	}
+
+	if (!options.save.empty())
+		bench_write_baseline(options.save, results);
+
+	exit(EXIT_SUCCESS);
+}
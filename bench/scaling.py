@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Scaling benchmark: generates instances of growing size with
+generate.out and solves each one with bnb.out under every strategy,
+reporting time, nodes and peak memory as a function of the size.
+
+Each solve runs in its own process, so its peak resident memory is
+the one the kernel reports for it. A strategy stops being run at the
+larger sizes of a type once one of its solves hits the time limit.
+
+    make scaling SCALING_ARGS="--types uniform,asymmetric --sizes 10:40:5"
+    python3 bench/scaling.py --strategies best,depth:additive --csv out.csv
+"""
+
+import argparse
+import csv
+import os
+import re
+import subprocess
+import sys
+import time
+
+SEARCHES = ("best", "breadth", "depth", "hybrid", "portfolio", "auto")
+BOUNDINGS = ("ap", "additive")
+BRANCHINGS = ("smallest", "regret", "bound", "strong")
+
+COLUMNS = ("type", "n", "seed", "strategy", "status", "seconds",
+           "expanded", "generated", "peak_mb", "cost")
+
+
+def parse_sizes(text):
+    """'10,20,40' or 'first:last:step'"""
+    if ":" in text:
+        first, last, step = (int(part) for part in text.split(":"))
+        return list(range(first, last + 1, step))
+
+    return [int(part) for part in text.split(",")]
+
+
+def strategy_flags(strategy):
+    """
+    Command line of a strategy named as in --portfolio, e.g.
+    'hybrid:additive:regret', its parts in any order
+    """
+    flags = []
+
+    for part in strategy.split(":"):
+        if part in SEARCHES:
+            flags += ["--search", part]
+        elif part in BOUNDINGS:
+            flags += ["--bounding", part]
+        elif part in BRANCHINGS:
+            flags += ["--branching", part]
+        else:
+            sys.exit("Unknown strategy part: " + part)
+
+    if "--search" not in flags:
+        sys.exit("Strategy without a search method: " + strategy)
+
+    return flags
+
+
+def generate(options, kind, n, seed):
+    path = os.path.join(options.dir, "%s%ds%d.%s" % (
+        kind, n, seed, "atsp" if kind == "asymmetric" else "tsp"))
+
+    if not os.path.exists(path):
+        subprocess.run([options.generator, "--type", kind, "--n", str(n),
+                        "--seed", str(seed), "--output", path], check=True,
+                       stdout=subprocess.DEVNULL)
+
+    return path
+
+
+def solve(options, strategy, path):
+    """
+    Runs the solver on `path`, returns its report: status, seconds,
+    nodes, cost and peak memory
+    """
+    command = [options.solver] + strategy_flags(strategy) + [
+        "--time-limit", str(options.time_limit)] + options.solver_args + [path]
+
+    # waited for by hand: wait4 gives the usage of this process only
+    start = time.monotonic()
+    process = subprocess.Popen(command, stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT, text=True)
+    output = process.stdout.read()
+    process.stdout.close()
+    _, status, usage = os.wait4(process.pid, 0)
+    process.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+    wall = time.monotonic() - start
+
+    report = {"status": "optimal", "seconds": wall, "expanded": "",
+              "generated": "", "cost": "",
+              # kilobytes on Linux, bytes on macOS
+              "peak_mb": usage.ru_maxrss / (1 << 20 if sys.platform == "darwin" else 1 << 10)}
+
+    if process.returncode != 0:
+        report["status"] = "error"
+        return report
+
+    match = re.search(r"duration: (\S+) seconds", output)
+    if match:
+        report["seconds"] = float(match.group(1))
+
+    match = re.search(r"Cost: (\S+)", output)
+    if match:
+        report["cost"] = match.group(1)
+
+    match = re.search(r"Nodes: (\d+) expanded, (\d+) generated", output)
+    if match:
+        report["expanded"] = int(match.group(1))
+        report["generated"] = int(match.group(2))
+
+    match = re.search(r"Stopped: (.+)", output)
+    if match:
+        report["status"] = match.group(1).strip().replace(" ", "_")
+
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--types", default="uniform,clustered,grid,asymmetric",
+                        help="instance types, comma separated (default: all four)")
+    parser.add_argument("--sizes", default="8:20:4",
+                        help="cities, 'a,b,c' or 'first:last:step' (default 8:20:4)")
+    parser.add_argument("--seeds", type=int, default=3,
+                        help="instances per type and size (default 3)")
+    parser.add_argument("--strategies", default="best,depth,hybrid",
+                        help="strategies as in --portfolio, comma separated "
+                             "(default best,depth,hybrid)")
+    parser.add_argument("--time-limit", type=float, default=30,
+                        help="seconds per solve (default 30)")
+    parser.add_argument("--solver-args", default="--exact-max 0",
+                        help="more options of every solve (default '--exact-max 0', "
+                             "so that small instances are searched)")
+    parser.add_argument("--dir", default="obj/scaling",
+                        help="where the instances are generated (default obj/scaling)")
+    parser.add_argument("--csv", help="also write every solve to this CSV file")
+    parser.add_argument("--solver", default="./bnb.out")
+    parser.add_argument("--generator", default="./generate.out")
+    options = parser.parse_args()
+    options.solver_args = options.solver_args.split()
+
+    os.makedirs(options.dir, exist_ok=True)
+    kinds = options.types.split(",")
+    sizes = parse_sizes(options.sizes)
+    strategies = options.strategies.split(",")
+
+    for strategy in strategies:
+        strategy_flags(strategy)
+
+    writer = None
+    if options.csv:
+        csv_file = open(options.csv, "w", newline="")
+        writer = csv.DictWriter(csv_file, fieldnames=COLUMNS)
+        writer.writeheader()
+
+    print("%-10s %5s %-24s %8s %10s %12s %9s %s" % (
+        "type", "n", "strategy", "solved", "seconds", "generated", "peak MB", "status"))
+
+    for kind in kinds:
+        # strategies that already hit the time limit on this type
+        stopped = set()
+
+        for n in sizes:
+            for strategy in strategies:
+                if strategy in stopped:
+                    continue
+
+                reports = []
+                for seed in range(1, options.seeds + 1):
+                    report = solve(options, strategy, generate(options, kind, n, seed))
+                    report.update(type=kind, n=n, seed=seed, strategy=strategy)
+                    reports.append(report)
+
+                    if writer:
+                        writer.writerow(report)
+
+                solved = [r for r in reports if r["status"] == "optimal"]
+                statuses = sorted(set(r["status"] for r in reports) - {"optimal"})
+
+                # medians over the instances, the unsolved ones included
+                def median(key):
+                    values = sorted(r[key] for r in reports if r[key] != "")
+                    return values[len(values) // 2] if values else float("nan")
+
+                print("%-10s %5d %-24s %4d/%-3d %10.3f %12s %9.1f %s" % (
+                    kind, n, strategy, len(solved), len(reports), median("seconds"),
+                    median("generated"), median("peak_mb"), ",".join(statuses)))
+                sys.stdout.flush()
+
+                if len(solved) < len(reports):
+                    stopped.add(strategy)
+
+    if writer:
+        csv_file.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,269 @@
+#include <iostream>
+#include <fstream> // output file
+#include <cstdlib> // exit(), strtoul()
+#include <cstring> // strcmp()
+#include <cstdint> // uint64_t
+#include <cmath> // sqrt, log, cos
+#include <string> // string
+#include <vector> // vector
+#include <algorithm> // min, max
+
+/**
+ * Writes synthetic TSPLIB instances: cities uniform in a square,
+ * gathered in clusters or on a grid (EUC_2D), or an asymmetric
+ * random cost matrix (ATSP, FULL_MATRIX)
+ *
+ * The same type, size and seed always give the same file, on any
+ * platform: the random numbers come from splitmix64 instead of the
+ * implementation defined distributions of <random>.
+ */
+
+#define GENERATE_UNIFORM 1
+#define GENERATE_CLUSTERED 2
+#define GENERATE_GRID 3
+#define GENERATE_ASYMMETRIC 4
+
+// side of the square the coordinates are drawn in, and largest
+// cost of an asymmetric instance
+#define DEFAULT_RANGE 1000
+
+// cities per cluster of a clustered instance, on average
+#define DEFAULT_CLUSTER_SIZE 25
+
+#define GENERATE_PI 3.14159265358979323846
+
+typedef struct s_generate_options {
+	int type;
+	int dimension;
+	uint64_t seed;
+	int range;
+	int cluster_size;
+
+	/**
+	 * File written, empty for the standard output
+	 */
+	std::string output;
+} GenerateOptions;
+
+// names indexed by type, 0 is none
+static const char *generate_type_names[] = { NULL, "uniform", "clustered", "grid", "asymmetric" };
+
+static void generate_usage () {
+	std::cout << " ./generate.out [options]" << std::endl
+		<< "  --type uniform|clustered|grid|asymmetric" << std::endl
+		<< "                      layout of the cities (default uniform)" << std::endl
+		<< "  --n N               number of cities" << std::endl
+		<< "  --seed S            random seed (default 1)" << std::endl
+		<< "  --range R           side of the square of the coordinates, largest" << std::endl
+		<< "                      asymmetric cost (default 1000)" << std::endl
+		<< "  --cluster-size N    clustered: cities per cluster on average (default 25)" << std::endl
+		<< "  --output FILE       file to write (default: standard output)" << std::endl;
+}
+
+static unsigned long generate_number (const char *option, const char *value) {
+	char *end;
+	unsigned long number = strtoul(value, &end, 10);
+
+	if (*value == '\0' || *end != '\0') {
+		std::cout << "Invalid value for " << option << ": " << value << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	return number;
+}
+
+static void generate_parse (GenerateOptions &options, int argc, char **argv) {
+	options.type = GENERATE_UNIFORM;
+	options.dimension = 0;
+	options.seed = 1;
+	options.range = DEFAULT_RANGE;
+	options.cluster_size = DEFAULT_CLUSTER_SIZE;
+	options.output.clear();
+
+	for (int i = 1; i < argc; ++i) {
+		const char *arg = argv[i];
+
+		if (strcmp(arg, "--help") == 0) {
+			generate_usage();
+			exit(EXIT_SUCCESS);
+		}
+
+		if (i + 1 >= argc) {
+			std::cout << "Missing value for " << arg << std::endl;
+			generate_usage();
+			exit(EXIT_FAILURE);
+		}
+
+		const char *value = argv[++i];
+
+		if (strcmp(arg, "--type") == 0) {
+			options.type = 0;
+			for (int type = GENERATE_UNIFORM; type <= GENERATE_ASYMMETRIC; ++type) {
+				if (strcmp(value, generate_type_names[type]) == 0)
+					options.type = type;
+			}
+
+			if (!options.type) {
+				std::cout << "Unknown instance type: " << value << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(arg, "--n") == 0) {
+			options.dimension = generate_number(arg, value);
+		} else if (strcmp(arg, "--seed") == 0) {
+			options.seed = generate_number(arg, value);
+		} else if (strcmp(arg, "--range") == 0) {
+			options.range = std::max(1ul, generate_number(arg, value));
+		} else if (strcmp(arg, "--cluster-size") == 0) {
+			options.cluster_size = std::max(1ul, generate_number(arg, value));
+		} else if (strcmp(arg, "--output") == 0) {
+			options.output = value;
+		} else {
+			std::cout << "Unknown option: " << arg << std::endl;
+			generate_usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (options.dimension < 3) {
+		std::cout << "An instance needs at least 3 cities (--n)" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * splitmix64: the next number of the sequence of `state`
+ */
+static uint64_t generate_next (uint64_t &state) {
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+/**
+ * Uniform in [0, 1)
+ */
+static double generate_uniform (uint64_t &state) {
+	return (generate_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Standard normal, by the Box-Muller transform
+ */
+static double generate_normal (uint64_t &state) {
+	double u = 1.0 - generate_uniform(state);
+	double v = generate_uniform(state);
+
+	return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * GENERATE_PI * v);
+}
+
+/**
+ * Coordinates of the cities, integers in [0, range]
+ */
+static void generate_coordinates (const GenerateOptions &options, uint64_t &state,
+		std::vector<int> &x, std::vector<int> &y) {
+	int n = options.dimension;
+	int range = options.range;
+
+	x.resize(n);
+	y.resize(n);
+
+	if (options.type == GENERATE_GRID) {
+		// the smallest square lattice holding every city, filled
+		// row by row
+		int side = std::ceil(std::sqrt((double) n));
+		double spacing = side > 1 ? (double) range / (side -1) : 0;
+
+		for (int i = 0; i < n; ++i) {
+			x[i] = std::floor((i % side) * spacing + 0.5);
+			y[i] = std::floor((i / side) * spacing + 0.5);
+		}
+	} else if (options.type == GENERATE_CLUSTERED) {
+		// centers uniform in the square, cities normally spread
+		// around a random center (as in the DIMACS challenge)
+		int clusters = std::max(1, n / options.cluster_size);
+		double spread = range / std::sqrt((double) clusters) / 4;
+		std::vector<double> cx (clusters), cy (clusters);
+
+		for (int c = 0; c < clusters; ++c) {
+			cx[c] = generate_uniform(state) * range;
+			cy[c] = generate_uniform(state) * range;
+		}
+
+		for (int i = 0; i < n; ++i) {
+			int c = generate_next(state) % clusters;
+			double px = cx[c] + spread * generate_normal(state);
+			double py = cy[c] + spread * generate_normal(state);
+
+			x[i] = std::floor(std::min((double) range, std::max(0.0, px)) + 0.5);
+			y[i] = std::floor(std::min((double) range, std::max(0.0, py)) + 0.5);
+		}
+	} else {
+		for (int i = 0; i < n; ++i) {
+			x[i] = generate_next(state) % (range +1);
+			y[i] = generate_next(state) % (range +1);
+		}
+	}
+}
+
+static void generate_write (const GenerateOptions &options, std::ostream &out) {
+	uint64_t state = options.seed;
+	const char *type = generate_type_names[options.type];
+	int n = options.dimension;
+
+	out << "NAME: " << type << n << "s" << options.seed << "\n"
+		<< "TYPE: " << (options.type == GENERATE_ASYMMETRIC ? "ATSP" : "TSP") << "\n"
+		<< "COMMENT: generated " << type << " instance, seed " << options.seed
+		<< ", range " << options.range << "\n"
+		<< "DIMENSION: " << n << "\n";
+
+	if (options.type == GENERATE_ASYMMETRIC) {
+		out << "EDGE_WEIGHT_TYPE: EXPLICIT\n"
+			<< "EDGE_WEIGHT_FORMAT: FULL_MATRIX\n"
+			<< "EDGE_WEIGHT_SECTION\n";
+
+		// costs uniform in [1, range], the diagonal is ignored
+		for (int i = 0; i < n; ++i) {
+			for (int j = 0; j < n; ++j) {
+				int cost = i == j ? 0 : 1 + generate_next(state) % options.range;
+				out << (j ? " " : "") << cost;
+			}
+			out << "\n";
+		}
+	} else {
+		std::vector<int> x, y;
+		generate_coordinates(options, state, x, y);
+
+		out << "EDGE_WEIGHT_TYPE: EUC_2D\n"
+			<< "NODE_COORD_SECTION\n";
+
+		for (int i = 0; i < n; ++i) {
+			out << i + 1 << " " << x[i] << " " << y[i] << "\n";
+		}
+	}
+
+	out << "EOF\n";
+}
+
+int main (int argc, char **argv) {
+	GenerateOptions options;
+	generate_parse(options, argc, argv);
+
+	if (options.output.empty()) {
+		generate_write(options, std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	std::ofstream out (options.output, std::ios::out | std::ios::trunc);
+	if (out)
+		generate_write(options, out);
+
+	out.close();
+	if (!out) {
+		std::cout << "Could not write " << options.output << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+#include <vector> // vector
+#include <limits> // numeric_limits
+#include "assignment.h"
+
+static const long UNREACHABLE = std::numeric_limits<long>::max() / 4;
+
+/**
+ * Scratch of the augmentations, one per thread, kept between calls
+ */
+typedef struct s_assignment_workspace {
+	std::vector<double> row;
+	std::vector<long> min_slack;
+	std::vector<int> way;
+	std::vector<bool> used;
+} AssignmentWorkspace;
+
+static thread_local AssignmentWorkspace assignment_workspace;
+
+/**
+ * Assigns the free row `row` (1 based) along a shortest augmenting
+ * path in the reduced costs, updating the duals so that they stay
+ * feasible and tight on the assigned arcs
+ *
+ * Each row of the path is read once, when its column is reached.
+ */
+static void assignment_augment (Assignment &assignment, int row,
+		hungarian_row_fn fill_row, void *ctx) {
+	AssignmentWorkspace &work = assignment_workspace;
+	int n = assignment.dimension;
+	std::vector<long> &u = assignment.u;
+	std::vector<long> &v = assignment.v;
+	std::vector<int> &row_of = assignment.row_of;
+
+	work.row.resize(n);
+	work.min_slack.assign(n + 1, UNREACHABLE);
+	work.way.assign(n + 1, 0);
+	work.used.assign(n + 1, false);
+
+	row_of[0] = row;
+	int col = 0;
+
+	do {
+		work.used[col] = true;
+
+		int curr_row = row_of[col];
+		long delta = UNREACHABLE;
+		int next_col = 0;
+
+		fill_row(ctx, curr_row - 1, work.row.data());
+
+		for (int j = 1; j <= n; ++j) {
+			if (work.used[j])
+				continue;
+
+			long slack = (long) work.row[j - 1] - u[curr_row] - v[j];
+			if (slack < work.min_slack[j]) {
+				work.min_slack[j] = slack;
+				work.way[j] = col;
+			}
+
+			if (work.min_slack[j] < delta) {
+				delta = work.min_slack[j];
+				next_col = j;
+			}
+		}
+
+		for (int j = 0; j <= n; ++j) {
+			if (work.used[j]) {
+				u[row_of[j]] += delta;
+				v[j] -= delta;
+			} else {
+				work.min_slack[j] -= delta;
+			}
+		}
+
+		col = next_col;
+	} while (row_of[col] != 0);
+
+	// flips the arcs of the path, back to the virtual column
+	do {
+		int prev_col = work.way[col];
+		row_of[col] = row_of[prev_col];
+		col = prev_col;
+	} while (col);
+}
+
+/**
+ * Every row and column is assigned, so the complementary slackness
+ * makes the dual objective the cost of the assignment
+ */
+static void assignment_set_cost (Assignment &assignment) {
+	long cost = 0;
+
+	for (int i = 1; i <= assignment.dimension; ++i) {
+		cost += assignment.u[i] + assignment.v[i];
+	}
+
+	assignment.cost = cost;
+}
+
+void assignment_solve (Assignment &assignment, int dimension,
+		hungarian_row_fn fill_row, void *ctx) {
+	assignment.dimension = dimension;
+	assignment.u.assign(dimension + 1, 0);
+	assignment.v.assign(dimension + 1, 0);
+	assignment.row_of.assign(dimension + 1, 0);
+
+	// starts from the column minima and then the row minima of what
+	// is left, as hungarian_solve does, which leaves the reduced
+	// costs spread over both
+	std::vector<double> &row = assignment_workspace.row;
+	row.resize(dimension);
+
+	std::vector<long> &u = assignment.u;
+	std::vector<long> &v = assignment.v;
+
+	for (int i = 0; i < dimension; ++i) {
+		fill_row(ctx, i, row.data());
+
+		for (int j = 0; j < dimension; ++j) {
+			if (i == 0 || (long) row[j] < v[j + 1])
+				v[j + 1] = row[j];
+		}
+	}
+
+	for (int i = 0; i < dimension; ++i) {
+		fill_row(ctx, i, row.data());
+
+		u[i + 1] = UNREACHABLE;
+		for (int j = 0; j < dimension; ++j) {
+			if ((long) row[j] - v[j + 1] < u[i + 1])
+				u[i + 1] = row[j] - v[j + 1];
+		}
+	}
+
+	for (int i = 1; i <= dimension; ++i) {
+		assignment_augment(assignment, i, fill_row, ctx);
+	}
+
+	assignment_set_cost(assignment);
+}
+
+void assignment_reoptimize (Assignment &assignment, int row, int col,
+		hungarian_row_fn fill_row, void *ctx) {
+	assignment.row_of[col + 1] = 0;
+	assignment_augment(assignment, row + 1, fill_row, ctx);
+
+	assignment_set_cost(assignment);
+}
+
+void assignment_successors (const Assignment &assignment, std::vector<int> &successor) {
+	successor.resize(assignment.dimension);
+
+	for (int j = 1; j <= assignment.dimension; ++j) {
+		successor[assignment.row_of[j] - 1] = j - 1;
+	}
+}
+
+void assignment_reduced_costs (const Assignment &assignment,
+		hungarian_row_fn fill_row, void *ctx, int **reduced_cost) {
+	int n = assignment.dimension;
+	std::vector<double> &row = assignment_workspace.row;
+	row.resize(n);
+
+	for (int i = 0; i < n; ++i) {
+		fill_row(ctx, i, row.data());
+
+		for (int j = 0; j < n; ++j) {
+			reduced_cost[i][j] = (long) row[j] - assignment.u[i + 1] - assignment.v[j + 1];
+		}
+	}
+}
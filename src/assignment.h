@@ -0,0 +1,68 @@
+#ifndef ASSIGNMENT_H
+#define ASSIGNMENT_H
+
+#include <vector> // vector
+#include "hungarian.h" // hungarian_row_fn
+
+/**
+ * Assignment problem solved by shortest augmenting paths, keeping
+ * the dual values so that the solution can be re-optimized after
+ * the cost of one assigned arc was raised
+ *
+ * Re-optimizing only has to reassign the row of that arc, which is
+ * a single augmentation: O(n^2) instead of the O(n^3) of a solve
+ * from scratch. The state is a few vectors of size n, so a search
+ * can keep one per level and restore it by copy when backtracking.
+ *
+ * Costs are read row by row through a hungarian_row_fn, rows and
+ * columns are 0 based in the interface.
+ */
+typedef struct s_assignment {
+	int dimension;
+
+	/**
+	 * Dual values of the rows and of the columns, 1 based: index 0
+	 * belongs to the virtual column the augmentations start from
+	 */
+	std::vector<long> u;
+	std::vector<long> v;
+
+	/**
+	 * row_of[j] is the row (1 based) assigned to column j, 0 when
+	 * the column is free
+	 */
+	std::vector<int> row_of;
+
+	/**
+	 * Cost of the optimal assignment
+	 */
+	long cost;
+} Assignment;
+
+/**
+ * Solves the `dimension` x `dimension` problem from scratch
+ */
+void assignment_solve (Assignment &assignment, int dimension,
+	hungarian_row_fn fill_row, void *ctx);
+
+/**
+ * Re-optimizes `assignment` after the cost of the arc (row, col),
+ * which it assigns, was raised: the duals stay feasible, so only
+ * `row` has to be reassigned
+ */
+void assignment_reoptimize (Assignment &assignment, int row, int col,
+	hungarian_row_fn fill_row, void *ctx);
+
+/**
+ * successor[i] is the column assigned to row i
+ */
+void assignment_successors (const Assignment &assignment, std::vector<int> &successor);
+
+/**
+ * Writes the reduced costs c[i][j] - u[i] - v[j] of the solution,
+ * all nonnegative, to the rows of `reduced_cost`
+ */
+void assignment_reduced_costs (const Assignment &assignment,
+	hungarian_row_fn fill_row, void *ctx, int **reduced_cost);
+
+#endif
@@ -0,0 +1,344 @@
+#include <iostream>
+#include <fstream> // ofstream
+#include <sstream> // ostringstream
+#include <vector> // vector
+#include <algorithm> // stable_sort, min, max
+#include <chrono> // probe timing
+#include <mutex> // mutex
+#include <cmath> // sqrt, isfinite
+#include "autotune.h"
+#include "search.h"
+#include "node.h"
+#include "patching.h"
+#include "bounding.h"
+#include "branching.h"
+#include "data.h" // INFINITE
+#include "json.h" // json_write_string
+
+// candidates probed, the best ranked by the features first
+#define AUTOTUNE_PROBES 3
+
+// root gap above which finding a tour early is worth more than
+// following the bounds
+#define AUTOTUNE_WIDE_GAP 0.05
+
+// instances above which strong branching costs more than it saves
+#define AUTOTUNE_STRONG_MAX 60
+
+typedef std::chrono::steady_clock Clock;
+
+static const Strategy autotune_candidates[] = {
+	{ HYBRID_SEARCH, BOUNDING_AP, BRANCHING_SMALLEST },
+	{ HYBRID_SEARCH, BOUNDING_ADDITIVE, BRANCHING_SMALLEST },
+	{ BEST_BOUND_SEARCH, BOUNDING_AP, BRANCHING_REGRET },
+	{ BEST_BOUND_SEARCH, BOUNDING_ADDITIVE, BRANCHING_SMALLEST },
+	{ DEPTH_FIRST_SEARCH, BOUNDING_ADDITIVE, BRANCHING_SMALLEST },
+	{ DEPTH_FIRST_SEARCH, BOUNDING_AP, BRANCHING_STRONG },
+	{ HYBRID_SEARCH, BOUNDING_AP, BRANCHING_STRONG },
+	{ HYBRID_SEARCH, BOUNDING_ADDITIVE, BRANCHING_BOUND },
+};
+
+typedef struct s_autotune_probe {
+	Strategy strategy;
+	int status;
+	double upper_bound;
+	double lower_bound;
+	long expanded;
+	double seconds;
+} AutotuneProbe;
+
+// searches of the server may log at once
+static std::mutex autotune_log_mutex;
+
+void autotune_features (TSPInfo &tsp_info, InstanceFeatures &features) {
+	tsp_prepare(tsp_info);
+
+	int n = tsp_info.dimension;
+	const SolverCosts &cost = *tsp_info.solver_costs;
+
+	features.dimension = n;
+	features.symmetric = tsp_info.cost_matrix->isSymmetric();
+	features.coordinates = tsp_info.neighbour_count > 0;
+
+	double sum = 0;
+	double squares = 0;
+	long arcs = 0;
+
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			double value = cost.get(i, j);
+
+			if (i == j || value >= INFINITE)
+				continue;
+
+			sum += value;
+			squares += value * value;
+			++arcs;
+		}
+	}
+
+	features.cost_mean = arcs ? sum / arcs : 0;
+	double variance = arcs ? squares / arcs - features.cost_mean * features.cost_mean : 0;
+	features.cost_spread = features.cost_mean > 0
+		? std::sqrt(std::max(variance, 0.0)) / features.cost_mean : 0;
+
+	Node root = node_new();
+	node_calculate_solution(root, tsp_info, NODE_NO_CUTOFF);
+
+	features.root_bound = root.lower_bound;
+	features.subtours = root.subtours.size();
+	features.smallest_subtour = n;
+	features.largest_subtour = 0;
+
+	for (size_t s = 0; s < root.subtours.size(); ++s) {
+		int size = root.subtours[s].size() -1;
+
+		features.smallest_subtour = std::min(features.smallest_subtour, size);
+		features.largest_subtour = std::max(features.largest_subtour, size);
+	}
+
+	std::vector<int> tour;
+	features.root_tour = root.cut ? root.lower_bound : patching_tour(tsp_info, root, tour);
+	features.root_gap = search_gap(features.root_tour, features.root_bound);
+
+	node_recycle(root);
+}
+
+/**
+ * How well `strategy` should suit an instance with `features`, the
+ * higher the sooner it is probed
+ *
+ * The additive bounding pays off on asymmetric costs, a wide root
+ * gap calls for the searches that find tours early and a narrow one
+ * for best-bound, and strong branching is only worth it on small
+ * instances.
+ */
+static int autotune_score (const Strategy &strategy, const InstanceFeatures &features) {
+	int score = 0;
+
+	if (strategy.bounding == BOUNDING_ADDITIVE)
+		score += features.symmetric ? -1 : 2;
+
+	if (features.root_gap > AUTOTUNE_WIDE_GAP)
+		score += strategy.search == BEST_BOUND_SEARCH ? -1 : 1;
+	else
+		score += strategy.search == BEST_BOUND_SEARCH ? 1 : 0;
+
+	if (strategy.branching == BRANCHING_STRONG)
+		score += features.dimension > AUTOTUNE_STRONG_MAX ? -2 : 0;
+
+	// many small subtours: the rules that look at their costs help
+	if (features.subtours > features.dimension / 4
+			&& (strategy.branching == BRANCHING_REGRET || strategy.branching == BRANCHING_BOUND))
+		score += 1;
+
+	return score;
+}
+
+/**
+ * Runs `strategy` on a copy of the instance for `seconds` at most,
+ * from the incumbent `tsp_info` has; `result` gets the copy back
+ */
+static void autotune_probe (TSPInfo &tsp_info, Options &options, const Strategy &strategy,
+		double seconds, TSPInfo &result, AutotuneProbe &probe) {
+	result = tsp_info;
+	result.bounding = strategy.bounding;
+	result.branching = strategy.branching;
+
+	Options probe_options = options;
+	probe_options.search = strategy.search;
+	probe_options.bounding = strategy.bounding;
+	probe_options.branching = strategy.branching;
+	probe_options.time_limit = seconds;
+	probe_options.quiet = true;
+	probe_options.checkpoint_path.clear();
+	probe_options.resume = false;
+
+	search_run(strategy.search, result, probe_options, NULL);
+
+	probe.strategy = strategy;
+	probe.status = result.status;
+	probe.upper_bound = result.upper_bound;
+	probe.lower_bound = result.lower_bound;
+	probe.expanded = result.stats.expanded;
+	probe.seconds = result.stats.elapsed;
+}
+
+/**
+ * Whether `a` did better than `b`: it finished, or else left the
+ * smaller gap, or the same gap with a higher bound
+ */
+static bool autotune_better (const AutotuneProbe &a, const AutotuneProbe &b) {
+	bool a_done = a.status == SEARCH_COMPLETE || a.status == SEARCH_GAP_LIMIT;
+	bool b_done = b.status == SEARCH_COMPLETE || b.status == SEARCH_GAP_LIMIT;
+
+	if (a_done != b_done)
+		return a_done;
+
+	if (a_done)
+		return a.seconds < b.seconds;
+
+	double a_gap = search_gap(a.upper_bound, a.lower_bound);
+	double b_gap = search_gap(b.upper_bound, b.lower_bound);
+
+	if (a_gap != b_gap)
+		return a_gap < b_gap;
+
+	return a.lower_bound > b.lower_bound;
+}
+
+/**
+ * Writes a number of the log, null when it isn't finite or stands
+ * for no tour
+ */
+static void autotune_number (std::ostream &out, double value) {
+	if (std::isfinite(value) && value < INFINITE)
+		out << value;
+	else
+		out << "null";
+}
+
+static void autotune_log (const Options &options, const InstanceFeatures &features,
+		const std::vector<AutotuneProbe> &probes, const Strategy &choice,
+		const TSPInfo &tsp_info) {
+	std::ostringstream line;
+
+	line << "{\"instance\":";
+	json_write_string(line, options.args.size() > 1 ? options.args[1] : "");
+
+	line << ",\"features\":{\"dimension\":" << features.dimension
+		<< ",\"symmetric\":" << (features.symmetric ? "true" : "false")
+		<< ",\"coordinates\":" << (features.coordinates ? "true" : "false")
+		<< ",\"root_bound\":";
+	autotune_number(line, features.root_bound);
+	line << ",\"root_tour\":";
+	autotune_number(line, features.root_tour);
+	line << ",\"root_gap\":";
+	autotune_number(line, features.root_gap);
+	line << ",\"subtours\":" << features.subtours
+		<< ",\"smallest_subtour\":" << features.smallest_subtour
+		<< ",\"largest_subtour\":" << features.largest_subtour
+		<< ",\"cost_mean\":" << features.cost_mean
+		<< ",\"cost_spread\":" << features.cost_spread << "}";
+
+	line << ",\"probes\":[";
+	for (size_t k = 0; k < probes.size(); ++k) {
+		const AutotuneProbe &probe = probes[k];
+
+		line << (k ? "," : "") << "{\"strategy\":";
+		json_write_string(line, options_strategy_name(probe.strategy));
+		line << ",\"status\":\"" << search_status_name(probe.status) << "\",\"cost\":";
+		autotune_number(line, probe.upper_bound);
+		line << ",\"lower_bound\":";
+		autotune_number(line, probe.lower_bound);
+		line << ",\"expanded\":" << probe.expanded
+			<< ",\"seconds\":" << probe.seconds << "}";
+	}
+	line << "]";
+
+	line << ",\"choice\":";
+	json_write_string(line, options_strategy_name(choice));
+	line << ",\"result\":{\"status\":\"" << search_status_name(tsp_info.status) << "\",\"cost\":";
+	autotune_number(line, tsp_info.upper_bound);
+	line << ",\"lower_bound\":";
+	autotune_number(line, tsp_info.lower_bound);
+	line << ",\"expanded\":" << tsp_info.stats.expanded
+		<< ",\"seconds\":" << tsp_info.stats.elapsed << "}}\n";
+
+	std::lock_guard<std::mutex> lock (autotune_log_mutex);
+	std::ofstream out(options.autotune_log, std::ios::out | std::ios::app);
+
+	if (!(out << line.str()) && !options.quiet)
+		std::cout << "Could not write autotune log " << options.autotune_log << std::endl;
+}
+
+void search_autotune (TSPInfo &tsp_info, Options &options) {
+	Clock::time_point start = Clock::now();
+
+	InstanceFeatures features;
+	autotune_features(tsp_info, features);
+
+	if (!options.quiet)
+		std::cout << "Autotune: " << features.dimension << " cities, "
+			<< (features.symmetric ? "symmetric" : "asymmetric") << ", root gap "
+			<< 100 * features.root_gap << "%, " << features.subtours << " subtours" << std::endl;
+
+	std::vector<Strategy> candidates (autotune_candidates,
+		autotune_candidates + sizeof(autotune_candidates) / sizeof(autotune_candidates[0]));
+
+	std::stable_sort(candidates.begin(), candidates.end(),
+		[&] (const Strategy &a, const Strategy &b) {
+			return autotune_score(a, features) > autotune_score(b, features); });
+
+	// the probes take at most half of a time limit
+	int count = std::min((int) candidates.size(), AUTOTUNE_PROBES);
+	double seconds = options.probe_time;
+	if (options.time_limit > 0)
+		seconds = std::min(seconds, options.time_limit / (2 * count));
+
+	std::vector<AutotuneProbe> probes (count);
+	TSPInfo result;
+	SearchStats spent = SearchStats();
+	size_t best = 0;
+	bool finished = false;
+
+	for (int k = 0; k < count && !finished; ++k) {
+		autotune_probe(tsp_info, options, candidates[k], seconds, result, probes[k]);
+
+		spent.expanded += result.stats.expanded;
+		spent.generated += result.stats.generated;
+
+		if (!options.quiet)
+			std::cout << "Probe " << options_strategy_name(candidates[k]) << ": "
+				<< search_status_name(result.status) << ", gap "
+				<< 100 * search_gap(result.upper_bound, result.lower_bound) << "%, "
+				<< result.stats.expanded << " nodes" << std::endl;
+
+		if (k == 0 || autotune_better(probes[k], probes[best]))
+			best = k;
+
+		// every search starts from the best tour found so far
+		if (result.upper_bound < tsp_info.upper_bound) {
+			tsp_info.upper_bound = result.upper_bound;
+			tsp_info.best_tour = result.best_tour;
+		}
+
+		// a probe that finished is the answer
+		if (result.status == SEARCH_COMPLETE || result.status == SEARCH_GAP_LIMIT) {
+			tsp_info.lower_bound = result.lower_bound;
+			tsp_info.status = result.status;
+			probes.resize(k +1);
+			finished = true;
+		}
+	}
+
+	const Strategy &choice = probes[best].strategy;
+
+	if (!options.quiet)
+		std::cout << "Autotune: " << options_strategy_name(choice)
+			<< (finished ? " finished" : " chosen") << std::endl;
+
+	if (!finished) {
+		Options final_options = options;
+		final_options.search = choice.search;
+		final_options.bounding = choice.bounding;
+		final_options.branching = choice.branching;
+
+		if (options.time_limit > 0) {
+			double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			final_options.time_limit = std::max(options.time_limit - elapsed, 0.001);
+		}
+
+		tsp_info.bounding = choice.bounding;
+		tsp_info.branching = choice.branching;
+		search_run(choice.search, tsp_info, final_options, NULL);
+	}
+
+	// the probes' work counts
+	tsp_info.stats.expanded = finished ? spent.expanded : tsp_info.stats.expanded + spent.expanded;
+	tsp_info.stats.generated = finished ? spent.generated : tsp_info.stats.generated + spent.generated;
+	tsp_info.stats.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	if (!options.autotune_log.empty())
+		autotune_log(options, features, probes, choice, tsp_info);
+}
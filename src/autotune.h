@@ -0,0 +1,45 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <string> // string
+#include "tsp.h"
+
+/**
+ * Cheap features of an instance, measured at the root
+ */
+typedef struct s_instance_features {
+	int dimension;
+	bool symmetric;
+
+	/**
+	 * Whether the cities have coordinates (the costs are then
+	 * a metric of them)
+	 */
+	bool coordinates;
+
+	/**
+	 * Cost of the assignment at the root, of the tour patched from
+	 * its subtours (see patching.h) and the relative gap between
+	 * them
+	 */
+	double root_bound;
+	double root_tour;
+	double root_gap;
+
+	/**
+	 * Subtours of the root assignment and their sizes
+	 */
+	int subtours;
+	int smallest_subtour;
+	int largest_subtour;
+
+	/**
+	 * Mean of the arc costs and their coefficient of variation
+	 */
+	double cost_mean;
+	double cost_spread;
+} InstanceFeatures;
+
+void autotune_features (TSPInfo &tsp_info, InstanceFeatures &features);
+
+#endif
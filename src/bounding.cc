@@ -0,0 +1,215 @@
+#include <vector> // vector
+#include <cstddef> // size_t
+#include <limits> // numeric_limits
+#include "bounding.h"
+
+static const long UNREACHABLE = std::numeric_limits<long>::max() / 4;
+
+/**
+ * Scratch of the additive bound, one per thread, kept between calls
+ * so that bounding a node allocates nothing
+ */
+typedef struct s_bounding_workspace {
+	std::vector<long> cost;
+	std::vector<int> label;
+
+	std::vector<long> out_min;
+	std::vector<long> in_min;
+
+	/**
+	 * Costs of the arborescence, of the graph being contracted and
+	 * of the one it contracts into
+	 */
+	std::vector<long> w;
+	std::vector<long> contracted;
+	std::vector<long> in;
+	std::vector<int> pre;
+	std::vector<int> id;
+	std::vector<int> visited;
+} BoundingWorkspace;
+
+static thread_local BoundingWorkspace bounding_workspace;
+
+/**
+ * Bound given by the subtours of the assignment: the arcs leaving
+ * different subtours are disjoint, so a tour costs at least the sum
+ * of the cheapest arc leaving each one (the same holds for entering
+ * arcs, the larger of both sums is taken)
+ *
+ * The arcs of the chosen cuts have their minimum subtracted from
+ * `cost`, which stays nonnegative
+ */
+static long bounding_subtour_cuts (std::vector<long> &cost, int dimension,
+		const std::vector<int> &label, int total_subtours) {
+	std::vector<long> &out_min = bounding_workspace.out_min;
+	std::vector<long> &in_min = bounding_workspace.in_min;
+	out_min.assign(total_subtours, UNREACHABLE);
+	in_min.assign(total_subtours, UNREACHABLE);
+
+	for (int a = 0; a < dimension; ++a) {
+		for (int b = 0; b < dimension; ++b) {
+			if (label[a] == label[b])
+				continue;
+
+			long c = cost[(size_t) a * dimension + b];
+			if (c < out_min[label[a]])
+				out_min[label[a]] = c;
+			if (c < in_min[label[b]])
+				in_min[label[b]] = c;
+		}
+	}
+
+	long out_sum = 0;
+	long in_sum = 0;
+	for (int s = 0; s < total_subtours; ++s) {
+		out_sum += out_min[s];
+		in_sum += in_min[s];
+	}
+
+	bool leaving = out_sum >= in_sum;
+
+	for (int a = 0; a < dimension; ++a) {
+		for (int b = 0; b < dimension; ++b) {
+			if (label[a] == label[b])
+				continue;
+
+			cost[(size_t) a * dimension + b] -= leaving ? out_min[label[a]] : in_min[label[b]];
+		}
+	}
+
+	return leaving ? out_sum : in_sum;
+}
+
+/**
+ * Cost of the shortest spanning arborescence rooted at `root`
+ * (Chu-Liu/Edmonds, contracting one round of cycles at a time)
+ *
+ * A tour without the arc entering the root is a spanning
+ * arborescence, so this bounds the cost of any tour
+ */
+static long bounding_arborescence (const std::vector<long> &cost, int dimension, int root) {
+	BoundingWorkspace &work = bounding_workspace;
+	int size = dimension;
+
+	std::vector<long> &w = work.w;
+	w.assign(cost.begin(), cost.end());
+
+	std::vector<long> &in = work.in;
+	std::vector<int> &pre = work.pre;
+	std::vector<int> &id = work.id;
+	std::vector<int> &visited = work.visited;
+	in.resize(size);
+	pre.resize(size);
+	id.resize(size);
+	visited.resize(size);
+
+	long total = 0;
+
+	while (true) {
+		// cheapest arc entering each vertex
+		for (int v = 0; v < size; ++v) {
+			in[v] = UNREACHABLE;
+			pre[v] = v;
+		}
+
+		for (int u = 0; u < size; ++u) {
+			for (int v = 0; v < size; ++v) {
+				long c = w[(size_t) u * size + v];
+				if (u != v && c < in[v]) {
+					in[v] = c;
+					pre[v] = u;
+				}
+			}
+		}
+
+		// looking for cycles among the chosen arcs
+		int cycles = 0;
+		in[root] = 0;
+
+		for (int v = 0; v < size; ++v) {
+			id[v] = -1;
+			visited[v] = -1;
+		}
+
+		for (int v = 0; v < size; ++v) {
+			total += in[v];
+
+			int x = v;
+			while (visited[x] != v && id[x] == -1 && x != root) {
+				visited[x] = v;
+				x = pre[x];
+			}
+
+			// x closed a new cycle
+			if (x != root && id[x] == -1) {
+				for (int u = pre[x]; u != x; u = pre[u]) {
+					id[u] = cycles;
+				}
+				id[x] = cycles++;
+			}
+		}
+
+		if (cycles == 0)
+			break;
+
+		for (int v = 0; v < size; ++v) {
+			if (id[v] == -1)
+				id[v] = cycles++;
+		}
+
+		// contracting every cycle into a single vertex, arcs entering
+		// a cycle are charged only what they cost above the cycle arc
+		// they replace
+		std::vector<long> &contracted = work.contracted;
+		contracted.assign((size_t) cycles * cycles, UNREACHABLE);
+
+		for (int u = 0; u < size; ++u) {
+			for (int v = 0; v < size; ++v) {
+				if (id[u] == id[v])
+					continue;
+
+				long c = w[(size_t) u * size + v] - in[v];
+				long &slot = contracted[(size_t) id[u] * cycles + id[v]];
+				if (c < slot)
+					slot = c;
+			}
+		}
+
+		root = id[root];
+		size = cycles;
+		w.swap(contracted);
+	}
+
+	return total;
+}
+
+long bounding_additive (int **reduced_cost, int dimension,
+		const std::vector< std::vector<int> > &subtours) {
+	std::vector<long> &cost = bounding_workspace.cost;
+	cost.resize((size_t) dimension * dimension);
+
+	for (int i = 0; i < dimension; ++i) {
+		for (int j = 0; j < dimension; ++j) {
+			cost[(size_t) i * dimension + j] = reduced_cost[i][j];
+		}
+	}
+
+	// subtour of each city, subtours hold 1-based cities and
+	// repeat the first one at the end
+	std::vector<int> &label = bounding_workspace.label;
+	label.resize(dimension);
+	for (size_t s = 0; s < subtours.size(); ++s) {
+		for (size_t k = 0; k < subtours[s].size() -1; ++k) {
+			label[subtours[s][k] -1] = s;
+		}
+	}
+
+	long bound = 0;
+
+	if (subtours.size() > 1)
+		bound += bounding_subtour_cuts(cost, dimension, label, subtours.size());
+
+	bound += bounding_arborescence(cost, dimension, 0);
+
+	return bound;
+}
@@ -0,0 +1,28 @@
+#ifndef BOUNDING_H
+#define BOUNDING_H
+
+#include <vector> // vector
+
+#define BOUNDING_AP 1
+#define BOUNDING_ADDITIVE 2
+
+/**
+ * Additive bounding procedure (Fischetti & Toth) applied after
+ * the assignment relaxation
+ *
+ * `reduced_cost` is the matrix left by hungarian_solve, whose
+ * entries are the reduced costs of the optimal assignment, and
+ * `subtours` its solution. Two further relaxations are solved in
+ * sequence, each on the costs left reduced by the previous one:
+ *
+ * - a disjunction of subtour cuts: every subtour of the assignment
+ *   has to be left (or entered) by at least one arc of a tour
+ * - the shortest spanning arborescence rooted at the first city
+ *
+ * Returns the sum of their bounds, which may be added to the cost
+ * of the assignment
+ */
+long bounding_additive (int **reduced_cost, int dimension,
+	const std::vector< std::vector<int> > &subtours);
+
+#endif
@@ -0,0 +1,281 @@
+#include <vector> // vector
+#include <algorithm> // sort, max
+#include <limits> // infinity
+#include "branching.h"
+#include "data.h" // INFINITE
+
+/**
+ * Whether subtour `a` comes before subtour `b` in the smallest
+ * rule: fewer cities, then the lowest first city
+ */
+static bool branching_smaller (const Node &node, int a, int b) {
+	const std::vector<int> &first = node.subtours[a];
+	const std::vector<int> &second = node.subtours[b];
+
+	if (first.size() != second.size())
+		return first.size() < second.size();
+
+	return first[0] < second[0];
+}
+
+/**
+ * Chooses the subtour of highest `score`, ties broken by the
+ * smallest rule
+ */
+static void branching_choose_best (Node &node, const std::vector<double> &score) {
+	int eligible_subtour = 0;
+
+	for (int i = 1; i < (int) node.subtours.size(); ++i) {
+		if (score[i] > score[eligible_subtour]
+				|| (score[i] == score[eligible_subtour]
+					&& branching_smaller(node, i, eligible_subtour)))
+			eligible_subtour = i;
+	}
+
+	node.chosen_subtour = eligible_subtour;
+}
+
+/**
+ * Finds the smallest subtour of `root` and assigns it to
+ * `root.chosen_subtour`
+ *
+ * In case of a tie, the subtour which the first node has
+ * the lowest index gets chosen
+ */
+static void branching_smallest (Node &root) {
+	int eligible_subtour = 0;
+
+	for (int i = 1; i < (int) root.subtours.size(); ++i) {
+		if (branching_smaller(root, i, eligible_subtour))
+			eligible_subtour = i;
+	}
+
+	root.chosen_subtour = eligible_subtour;
+}
+
+static void branching_regret (Node &node, TSPInfo &tsp_info, int **reduced_cost) {
+	std::vector<double> score (node.subtours.size(), 0);
+
+	for (size_t s = 0; s < node.subtours.size(); ++s) {
+		const std::vector<int> &subtour = node.subtours[s];
+		double regret = std::numeric_limits<double>::infinity();
+
+		// the regret of an arc of the assignment is the cheapest other
+		// reduced cost of its row plus that of its column. Each child
+		// prohibits one arc, so the subtour is only as good as its arc
+		// of least regret (an average favours large subtours of cheap
+		// arcs, whose many children each gain little)
+		for (size_t k = 0; k + 1 < subtour.size(); ++k) {
+			int from = subtour[k] -1;
+			int to = subtour[k +1] -1;
+			double row = INFINITE;
+			double column = INFINITE;
+
+			for (int j = 0; j < tsp_info.dimension; ++j) {
+				if (j != to && reduced_cost[from][j] < row)
+					row = reduced_cost[from][j];
+				if (j != from && reduced_cost[j][to] < column)
+					column = reduced_cost[j][to];
+			}
+
+			if (row + column < regret)
+				regret = row + column;
+		}
+
+		score[s] = regret;
+	}
+
+	branching_choose_best(node, score);
+}
+
+static void branching_bound (Node &node, TSPInfo &tsp_info, int **reduced_cost) {
+	std::vector<double> score (node.subtours.size(), 0);
+
+	for (size_t s = 0; s < node.subtours.size(); ++s) {
+		const std::vector<int> &subtour = node.subtours[s];
+		double increase = std::numeric_limits<double>::infinity();
+
+		// prohibiting an arc of the assignment costs at least the
+		// cheapest other reduced cost of its row
+		for (size_t k = 0; k + 1 < subtour.size(); ++k) {
+			int from = subtour[k] -1;
+			int to = subtour[k +1] -1;
+			const int *row = reduced_cost[from];
+
+			for (int j = 0; j < tsp_info.dimension; ++j) {
+				if (j != to && row[j] < increase)
+					increase = row[j];
+			}
+		}
+
+		score[s] = increase;
+	}
+
+	branching_choose_best(node, score);
+}
+
+/**
+ * branching_reversible() for the edges applied to `overlay`
+ */
+static bool branching_overlay_reversible (const CostOverlay &overlay) {
+	if (overlay.size() % 2)
+		return false;
+
+	for (size_t k = 0; k < overlay.size(); k += 2) {
+		const CostOverlay::Entry &edge = overlay.getEntry(k);
+		const CostOverlay::Entry &reverse = overlay.getEntry(k +1);
+
+		if (edge.i != reverse.j || edge.j != reverse.i)
+			return false;
+	}
+
+	return true;
+}
+
+static void branching_strong (Node &node, TSPInfo &tsp_info) {
+	int total_subtours = node.subtours.size();
+
+	std::vector<int> candidates (total_subtours);
+	for (int i = 0; i < total_subtours; ++i) {
+		candidates[i] = i;
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [&] (int a, int b) {
+		return branching_smaller(node, a, b); });
+
+	if ((int) candidates.size() > tsp_info.lookahead)
+		candidates.resize(tsp_info.lookahead > 0 ? tsp_info.lookahead : 1);
+
+	// the children are evaluated with the smallest rule, so that the
+	// lookahead doesn't recurse
+	int branching = tsp_info.branching;
+	tsp_info.branching = BRANCHING_SMALLEST;
+
+	// the overlay holds every prohibited edge of `node`, its own
+	// list may only have those added since its parent
+	bool reversible = branching_overlay_reversible(tsp_info.cost_overlay);
+
+	int eligible_subtour = candidates[0];
+	double best_score = -std::numeric_limits<double>::infinity();
+
+	for (size_t c = 0; c < candidates.size(); ++c) {
+		// copied: evaluating a child reuses the node pool buffers
+		std::vector<int> subtour = node.subtours[candidates[c]];
+		double score = std::numeric_limits<double>::infinity();
+
+		size_t children = branching_child_count(tsp_info, subtour, reversible);
+
+		for (size_t k = 0; k < children && score > best_score; ++k) {
+			// the prohibited edges of `node` are already applied
+			Node child = node_new();
+			branching_child_edges(tsp_info, subtour, k, child.prohibited_edges);
+
+			// solved in full, the bound is the score
+			node_calculate_solution(child, tsp_info, NODE_NO_CUTOFF);
+			if (child.lower_bound < score)
+				score = child.lower_bound;
+
+			node_recycle(child);
+		}
+
+		// candidates come in the order of the smallest rule, so a
+		// tie keeps the earlier one
+		if (score > best_score) {
+			best_score = score;
+			eligible_subtour = candidates[c];
+		}
+	}
+
+	tsp_info.branching = branching;
+	node.chosen_subtour = eligible_subtour;
+}
+
+void branching_choose_subtour (Node &node, TSPInfo &tsp_info, int **reduced_cost) {
+	if (node.subtours.size() == 1) {
+		node.chosen_subtour = 0;
+		return;
+	}
+
+	switch (tsp_info.branching) {
+	case BRANCHING_REGRET:
+		branching_regret(node, tsp_info, reduced_cost);
+		break;
+	case BRANCHING_BOUND:
+		branching_bound(node, tsp_info, reduced_cost);
+		break;
+	case BRANCHING_STRONG:
+		branching_strong(node, tsp_info);
+		break;
+	default:
+		branching_smallest(node);
+		break;
+	}
+}
+
+bool branching_needs_reduced_costs (int branching) {
+	return branching == BRANCHING_REGRET || branching == BRANCHING_BOUND;
+}
+
+bool branching_reversible (const std::pair<int, int> *edges, size_t count) {
+	if (count % 2)
+		return false;
+
+	for (size_t k = 0; k < count; k += 2) {
+		if (edges[k].first != edges[k +1].second || edges[k].second != edges[k +1].first)
+			return false;
+	}
+
+	return true;
+}
+
+void branching_child_bounds (Node &node, const TSPInfo &tsp_info, double cost,
+		int **reduced_cost) {
+	const std::vector<int> &subtour = node.subtours[node.chosen_subtour];
+	int dimension = tsp_info.dimension;
+
+	// the overlay holds every prohibited edge of `node`
+	size_t count = branching_child_count(tsp_info, subtour,
+		branching_overlay_reversible(tsp_info.cost_overlay));
+
+	node.child_bounds.resize(count);
+
+	for (size_t k = 0; k < count; ++k) {
+		// the first arc a child prohibits is the assigned one
+		int from = subtour[k] -1;
+		int to = subtour[k +1] -1;
+		double row_increase = INFINITE;
+		double column_increase = INFINITE;
+
+		for (int j = 0; j < dimension; ++j) {
+			if (j != to && reduced_cost[from][j] < row_increase)
+				row_increase = reduced_cost[from][j];
+		}
+
+		for (int i = 0; i < dimension; ++i) {
+			if (i != from && reduced_cost[i][to] < column_increase)
+				column_increase = reduced_cost[i][to];
+		}
+
+		node.child_bounds[k] = std::max(node.lower_bound, cost + row_increase + column_increase);
+	}
+}
+
+size_t branching_child_count (const TSPInfo &tsp_info, const std::vector<int> &subtour,
+		bool reversible) {
+	// subtours are closed, their last city repeats the first
+	size_t arcs = subtour.size() -1;
+
+	if (tsp_info.symmetric_branching && arcs == 2 && reversible)
+		return 1;
+
+	return arcs;
+}
+
+void branching_child_edges (const TSPInfo &tsp_info, const std::vector<int> &subtour,
+		size_t k, std::vector< std::pair<int, int> > &edges) {
+	edges.push_back(std::pair<int, int> (subtour[k], subtour[k +1]));
+
+	// a 2-cycle's children are directed, whatever their number
+	if (tsp_info.symmetric_branching && subtour.size() > 3)
+		edges.push_back(std::pair<int, int> (subtour[k +1], subtour[k]));
+}
@@ -0,0 +1,86 @@
+#ifndef BRANCHING_H
+#define BRANCHING_H
+
+#include "tsp.h"
+#include "node.h"
+
+/**
+ * Rules choosing the subtour a node is branched on: each of its
+ * arcs gives a child in which that arc is prohibited (see
+ * branching_child_edges)
+ *
+ * - smallest: fewest arcs, hence fewest children
+ * - regret: largest regret of its arc of least regret, the cheapest
+ *   other reduced cost of the arc's row plus that of its column
+ * - bound: largest bound increase every child is sure to get,
+ *   estimated from the reduced costs of the assignment
+ * - strong: the children of the `lookahead` smallest subtours are
+ *   evaluated, the subtour whose weakest child has the highest
+ *   bound is chosen
+ *
+ * Ties are broken by the smallest rule, and among subtours of the
+ * same size by the lowest first city.
+ */
+#define BRANCHING_SMALLEST 1
+#define BRANCHING_REGRET 2
+#define BRANCHING_BOUND 3
+#define BRANCHING_STRONG 4
+
+#define DEFAULT_LOOKAHEAD 3
+
+/**
+ * Sets `node.chosen_subtour` following tsp_info.branching
+ *
+ * Called while the prohibited edges of `node` are applied to
+ * tsp_info.cost_overlay. `reduced_cost` holds the reduced costs of
+ * its assignment, it is only read by BRANCHING_REGRET and
+ * BRANCHING_BOUND.
+ */
+void branching_choose_subtour (Node &node, TSPInfo &tsp_info, int **reduced_cost);
+
+/**
+ * Whether `branching` reads the reduced costs
+ */
+bool branching_needs_reduced_costs (int branching);
+
+/**
+ * Whether the `count` prohibited edges of a node are closed under
+ * reversal, as symmetric branching leaves them: each one is followed
+ * by its reverse. A tour and its reverse are then both feasible in
+ * the node or both not.
+ */
+bool branching_reversible (const std::pair<int, int> *edges, size_t count);
+
+/**
+ * Sets `node.child_bounds` from the reduced costs of its assignment
+ * of cost `cost`, once its subtour is chosen
+ *
+ * Prohibiting the assigned arc (a, b) lets the dual of row a rise by
+ * the cheapest other reduced cost of its row, and that of column b
+ * by the cheapest other one of its column: the child's relaxation
+ * costs at least their sum more. Each bound is also at least the
+ * node's own, every tour of a child being a tour of the node.
+ */
+void branching_child_bounds (Node &node, const TSPInfo &tsp_info, double cost,
+	int **reduced_cost);
+
+/**
+ * Children of a node branched on `subtour`: how many there are, and
+ * the arcs child k prohibits on top of those of the node, appended
+ * to `edges` (the arc of the subtour first)
+ *
+ * Child k prohibits the k-th arc of the subtour. With symmetric
+ * branching (tsp_info.symmetric_branching) it prohibits the
+ * undirected edge instead, both of its arcs, so the reverse arc
+ * can't bring the subtour back; no tour holds every edge of a
+ * subtour of three cities or more. A 2-cycle has a single edge, it
+ * keeps two directed children unless the node is `reversible`: a
+ * tour using one of its arcs can then be reversed, so the child
+ * prohibiting the other arc is the only one needed.
+ */
+size_t branching_child_count (const TSPInfo &tsp_info, const std::vector<int> &subtour,
+	bool reversible);
+void branching_child_edges (const TSPInfo &tsp_info, const std::vector<int> &subtour,
+	size_t k, std::vector< std::pair<int, int> > &edges);
+
+#endif
@@ -0,0 +1,338 @@
+#include <fstream> // ifstream, ofstream
+#include <sstream> // ostringstream
+#include <iomanip> // setprecision, setw, setfill
+#include <vector> // vector
+#include <algorithm> // sort, max
+#include <utility> // pair
+#include <thread> // this_thread
+#include <functional> // hash
+#include <cstdio> // rename()
+#include <cstdint> // uint64_t
+#include <cerrno> // errno
+#include <unistd.h> // getpid, unlink
+#include <dirent.h> // opendir, readdir
+#include <utime.h> // utime
+#include <sys/stat.h> // stat, mkdir
+#include "cache.h"
+#include "search.h" // SEARCH_*, search_gap
+#include "data.h" // INFINITE
+
+#define CACHE_MAGIC "BNB-CACHE"
+#define CACHE_VERSION 2
+#define CACHE_SUFFIX ".result"
+
+/**
+ * Revision of the solver, raised whenever a search is found to have
+ * claimed proofs it didn't make (see cache_proof_sound). Revision 1,
+ * the entries of the first version, ended the later siblings of a
+ * child that was pruned or a tour under directed branching, and
+ * could return a worse tour with a closed gap.
+ */
+#define CACHE_SOLVER 2
+
+/**
+ * 128 bit hash of the costs as the search sees them (independent
+ * of the storage layout): two 64 bit hashes of the entries, FNV-1a
+ * and a multiply-xorshift one, so that a collision needs both to
+ * collide
+ */
+static std::string cache_key (const CostMatrix &cost_matrix) {
+	int dimension = cost_matrix.getDimension();
+	std::vector<double> row (dimension);
+
+	uint64_t fnv = 14695981039346656037ULL;
+	uint64_t mix = 0x9E3779B97F4A7C15ULL ^ (uint64_t) dimension;
+
+	for (int i = 0; i < dimension; ++i) {
+		cost_matrix.getRow(i, row.data());
+
+		for (int j = 0; j < dimension; ++j) {
+			uint64_t value = (uint64_t) (int64_t) row[j];
+
+			for (int b = 0; b < 8; ++b) {
+				fnv = (fnv ^ ((value >> (8 * b)) & 0xFF)) * 1099511628211ULL;
+			}
+
+			mix = (mix ^ value) * 0xBF58476D1CE4E5B9ULL;
+			mix ^= mix >> 31;
+		}
+	}
+
+	std::ostringstream key;
+	key << std::hex << std::setfill('0') << std::setw(16) << fnv << std::setw(16) << mix;
+
+	return key.str();
+}
+
+static std::string cache_path (const std::string &dir, const std::string &key) {
+	return dir + "/" + key + CACHE_SUFFIX;
+}
+
+/**
+ * Whether `tour` visits every city of `tsp_info` once and costs
+ * `cost`, which also catches an entry of another instance with the
+ * same key
+ */
+static bool cache_check_tour (const TSPInfo &tsp_info, const std::vector<int> &tour, double cost) {
+	int dimension = tsp_info.dimension;
+
+	if ((int) tour.size() != dimension + 1 || tour.front() != tour.back())
+		return false;
+
+	std::vector<bool> visited (dimension, false);
+	double length = 0;
+
+	for (int k = 0; k < dimension; ++k) {
+		int from = tour[k] -1;
+		int to = tour[k +1] -1;
+
+		if (from < 0 || from >= dimension || to < 0 || to >= dimension || visited[from])
+			return false;
+
+		visited[from] = true;
+		length += tsp_info.cost_matrix->get(from, to);
+	}
+
+	return length == cost;
+}
+
+static bool cache_read (const std::string &path, CacheEntry &entry) {
+	std::ifstream in(path, std::ios::in);
+
+	if (!in)
+		return false;
+
+	std::string word, key;
+	int version;
+
+	in >> word >> version;
+	if (word != CACHE_MAGIC || version < 1 || version > CACHE_VERSION)
+		return false;
+
+	in >> word >> key;
+	in >> word >> entry.dimension;
+	in >> word >> entry.complete;
+
+	// the first version didn't record how its proof was made
+	entry.solver = 1;
+	entry.search = 0;
+	if (version >= 2)
+		in >> word >> entry.solver >> entry.search >> entry.bounding
+			>> entry.branching >> entry.symmetric;
+
+	in >> word >> entry.upper_bound;
+	in >> word >> entry.lower_bound;
+	in >> word >> entry.stats.expanded
+		>> entry.stats.generated
+		>> entry.stats.elapsed;
+
+	size_t size;
+	in >> word >> size;
+	if (!in || key != entry.key || size > (size_t) entry.dimension + 1)
+		return false;
+
+	entry.best_tour.resize(size);
+	for (size_t i = 0; i < size; ++i) {
+		in >> entry.best_tour[i];
+	}
+
+	return (bool) in;
+}
+
+static bool cache_write (const std::string &path, const CacheEntry &entry) {
+	// other processes and threads may write the same entry
+	std::ostringstream tmp_path;
+	tmp_path << path << "." << getpid() << "."
+		<< std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+
+	std::ofstream out(tmp_path.str(), std::ios::out | std::ios::trunc);
+
+	if (!out)
+		return false;
+
+	out << std::setprecision(17);
+	out << CACHE_MAGIC << " " << CACHE_VERSION << "\n";
+	out << "key " << entry.key << "\n";
+	out << "dimension " << entry.dimension << "\n";
+	out << "complete " << entry.complete << "\n";
+	out << "proof " << entry.solver << " " << entry.search << " " << entry.bounding << " "
+		<< entry.branching << " " << entry.symmetric << "\n";
+	out << "upper_bound " << entry.upper_bound << "\n";
+	out << "lower_bound " << entry.lower_bound << "\n";
+	out << "stats " << entry.stats.expanded << " "
+		<< entry.stats.generated << " "
+		<< entry.stats.elapsed << "\n";
+	out << "tour " << entry.best_tour.size();
+	for (size_t i = 0; i < entry.best_tour.size(); ++i) {
+		out << " " << entry.best_tour[i];
+	}
+	out << "\n";
+
+	out.close();
+	if (!out || std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+		unlink(tmp_path.str().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Removes the least recently used entries (by modification time,
+ * which a hit refreshes) until the cache takes at most `max_bytes`
+ */
+static void cache_evict (const std::string &dir, long max_bytes) {
+	DIR *handle = opendir(dir.c_str());
+
+	if (!handle)
+		return;
+
+	std::vector< std::pair<time_t, std::string> > files;
+	std::vector<long> sizes;
+	long total = 0;
+
+	size_t suffix = sizeof(CACHE_SUFFIX) -1;
+
+	for (dirent *file = readdir(handle); file; file = readdir(handle)) {
+		std::string name = file->d_name;
+
+		if (name.size() <= suffix || name.compare(name.size() - suffix, suffix, CACHE_SUFFIX) != 0)
+			continue;
+
+		struct stat status;
+		std::string path = dir + "/" + name;
+		if (stat(path.c_str(), &status) != 0)
+			continue;
+
+		files.push_back(std::pair<time_t, std::string> (status.st_mtime, path));
+		total += status.st_size;
+	}
+
+	closedir(handle);
+
+	if (total <= max_bytes)
+		return;
+
+	std::sort(files.begin(), files.end());
+
+	for (size_t i = 0; i < files.size() && total > max_bytes; ++i) {
+		struct stat status;
+
+		if (stat(files[i].second.c_str(), &status) == 0 && unlink(files[i].second.c_str()) == 0)
+			total -= status.st_size;
+	}
+}
+
+/**
+ * Whether the proof of `entry` (`complete` and `lower_bound`) holds
+ * for any request: only those of the current solver revision are
+ * trusted. Their settings are kept so that a later revision can
+ * distrust just the proofs of the settings it fixes.
+ */
+static bool cache_proof_sound (const CacheEntry &entry) {
+	return entry.solver == CACHE_SOLVER;
+}
+
+/**
+ * Records the settings of `options` and `tsp_info` as those the
+ * proof of `entry` was made under
+ */
+static void cache_set_proof (CacheEntry &entry, const Options &options, const TSPInfo &tsp_info) {
+	entry.solver = CACHE_SOLVER;
+	entry.search = options.search;
+	entry.bounding = tsp_info.bounding;
+	entry.branching = tsp_info.branching;
+	entry.symmetric = tsp_info.symmetric_branching;
+}
+
+bool cache_load (const Options &options, TSPInfo &tsp_info, CacheEntry &entry) {
+	entry.key = cache_key(*tsp_info.cost_matrix);
+	entry.dimension = tsp_info.dimension;
+	entry.complete = false;
+	entry.solver = CACHE_SOLVER;
+	entry.search = 0;
+	entry.bounding = 0;
+	entry.branching = 0;
+	entry.symmetric = false;
+	entry.upper_bound = INFINITE;
+	entry.lower_bound = 0;
+	entry.best_tour.clear();
+	entry.stats = SearchStats();
+
+	std::string path = cache_path(options.cache_dir, entry.key);
+	CacheEntry cached = entry;
+
+	if (!cache_read(path, cached) || cached.dimension != tsp_info.dimension)
+		return false;
+
+	// an entry whose tour doesn't check out is ignored, and
+	// replaced by the next store
+	if (cached.best_tour.size() && !cache_check_tour(tsp_info, cached.best_tour, cached.upper_bound))
+		return false;
+
+	if (cached.best_tour.empty())
+		cached.upper_bound = INFINITE;
+
+	// a proof that may not hold is dropped, the tour is only a
+	// starting incumbent and the next store records a new proof
+	if (!cache_proof_sound(cached)) {
+		cached.complete = false;
+		cached.lower_bound = 0;
+		cache_set_proof(cached, options, tsp_info);
+	}
+
+	entry = cached;
+	utime(path.c_str(), NULL);
+
+	double cached_gap = search_gap(entry.upper_bound, entry.lower_bound);
+
+	if (entry.complete || (options.gap >= 0 && cached_gap <= options.gap)) {
+		tsp_info.upper_bound = entry.upper_bound;
+		tsp_info.lower_bound = entry.complete ? entry.upper_bound : entry.lower_bound;
+		tsp_info.best_tour = entry.best_tour;
+		tsp_info.stats = entry.stats;
+		tsp_info.status = entry.complete ? SEARCH_COMPLETE : SEARCH_GAP_LIMIT;
+		return true;
+	}
+
+	if (entry.best_tour.size() && entry.upper_bound < tsp_info.upper_bound) {
+		tsp_info.upper_bound = entry.upper_bound;
+		tsp_info.best_tour = entry.best_tour;
+	}
+
+	return false;
+}
+
+bool cache_store (const Options &options, const TSPInfo &tsp_info, CacheEntry &entry) {
+	if (tsp_info.best_tour.size() && tsp_info.upper_bound < entry.upper_bound) {
+		entry.upper_bound = tsp_info.upper_bound;
+		entry.best_tour = tsp_info.best_tour;
+	}
+
+	// every search proves its own bound, the best one holds along
+	// with the settings it was proven under
+	if (!entry.complete && (tsp_info.status == SEARCH_COMPLETE
+			|| tsp_info.lower_bound > entry.lower_bound))
+		cache_set_proof(entry, options, tsp_info);
+
+	entry.lower_bound = std::max(entry.lower_bound, tsp_info.lower_bound);
+
+	if (tsp_info.status == SEARCH_COMPLETE)
+		entry.complete = true;
+
+	if (entry.complete || entry.lower_bound > entry.upper_bound)
+		entry.lower_bound = entry.upper_bound;
+
+	entry.stats.expanded += tsp_info.stats.expanded;
+	entry.stats.generated += tsp_info.stats.generated;
+	entry.stats.elapsed += tsp_info.stats.elapsed;
+
+	if (mkdir(options.cache_dir.c_str(), 0755) != 0 && errno != EEXIST)
+		return false;
+
+	if (!cache_write(cache_path(options.cache_dir, entry.key), entry))
+		return false;
+
+	cache_evict(options.cache_dir, options.cache_size);
+	return true;
+}
@@ -0,0 +1,75 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <string> // string
+#include <vector> // vector
+#include "tsp.h"
+#include "options.h"
+
+/**
+ * On-disk cache of solve results, one file per instance named after
+ * a hash of its cost matrix, so an instance is found again whatever
+ * file (or inline matrix) it came from
+ */
+typedef struct s_cache_entry {
+	/**
+	 * Hash of the cost matrix, in hexadecimal
+	 */
+	std::string key;
+
+	int dimension;
+
+	/**
+	 * Whether a search ran to completion, i.e. `upper_bound` is
+	 * the optimum
+	 */
+	bool complete;
+
+	/**
+	 * Settings `complete` and `lower_bound` were proven under: the
+	 * revision of the solver that proved them (see CACHE_SOLVER),
+	 * its search, bounding, branching and whether it branched on
+	 * undirected edges (the search is 0 when the entry doesn't say).
+	 */
+	int solver;
+	int search;
+	int bounding;
+	int branching;
+	bool symmetric;
+
+	/**
+	 * Best tour known and its cost (INFINITE and empty if none), and
+	 * the best lower bound proven by the solves so far
+	 */
+	double upper_bound;
+	double lower_bound;
+	std::vector<int> best_tour;
+
+	/**
+	 * Totals of the solves so far
+	 */
+	SearchStats stats;
+} CacheEntry;
+
+/**
+ * Looks the instance of `tsp_info` up in the cache of `options`,
+ * `entry` gets its key and whatever was cached
+ *
+ * Returns true when the cached result is optimal, or within the gap
+ * of `options` of its lower bound (a negative gap only accepts
+ * optimal ones), and its proof was made under settings known to be
+ * sound: `tsp_info` is then filled with it as if it were searched.
+ * Otherwise a cached tour better than the incumbent becomes the
+ * incumbent, and the search starts from it.
+ */
+bool cache_load (const Options &options, TSPInfo &tsp_info, CacheEntry &entry);
+
+/**
+ * Merges the result of a search in `tsp_info`, run with `options`,
+ * into `entry` (as given by cache_load()) and saves it, then drops
+ * the least recently used entries while the cache is above the size
+ * of `options`
+ */
+bool cache_store (const Options &options, const TSPInfo &tsp_info, CacheEntry &entry);
+
+#endif
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <fstream> // ifstream, ofstream
+#include <iomanip> // setprecision
+#include <cstdio> // rename()
+#include <utility> // move
+#include <fcntl.h> // open
+#include <unistd.h> // fsync, close
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "BNB-CHECKPOINT"
+#define CHECKPOINT_VERSION 2
+
+// oldest version still read, its nodes have no children created
+#define CHECKPOINT_MIN_VERSION 1
+
+static void checkpoint_write_list (std::ofstream &out, const std::vector<int> &list) {
+	out << list.size();
+	for (size_t i = 0; i < list.size(); ++i) {
+		out << " " << list[i];
+	}
+	out << "\n";
+}
+
+static bool checkpoint_read_list (std::ifstream &in, std::vector<int> &list) {
+	size_t size;
+	if (!(in >> size))
+		return false;
+
+	list.resize(size);
+	for (size_t i = 0; i < size; ++i) {
+		if (!(in >> list[i]))
+			return false;
+	}
+
+	return true;
+}
+
+void checkpoint_add_node (Checkpoint &checkpoint, const Node &node) {
+	Node compact;
+	compact.prohibited_edges = node.prohibited_edges;
+	compact.lower_bound = node.lower_bound;
+	compact.subtours.push_back(node.subtours[node.chosen_subtour]);
+	compact.chosen_subtour = 0;
+	compact.cut = node.cut;
+	compact.next_child = node.next_child;
+	compact.child_bounds = node.child_bounds;
+
+	checkpoint.frontier.push_back(compact);
+}
+
+/**
+ * Flushes the file or directory at `path` to the disk
+ */
+static bool checkpoint_sync (const std::string &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	bool synced = fsync(fd) == 0;
+	close(fd);
+
+	return synced;
+}
+
+bool checkpoint_write (const std::string &path, const Checkpoint &checkpoint) {
+	std::string tmp_path = path + ".tmp";
+	std::ofstream out(tmp_path, std::ios::out | std::ios::trunc);
+
+	if (!out)
+		return false;
+
+	out << std::setprecision(17);
+	out << CHECKPOINT_MAGIC << " " << CHECKPOINT_VERSION << "\n";
+	out << "search " << checkpoint.search << "\n";
+	out << "dimension " << checkpoint.dimension << "\n";
+	out << "upper_bound " << checkpoint.upper_bound << "\n";
+	out << "stats " << checkpoint.stats.expanded << " "
+		<< checkpoint.stats.generated << " "
+		<< checkpoint.stats.elapsed << "\n";
+	out << "tour ";
+	checkpoint_write_list(out, checkpoint.best_tour);
+
+	// one line per open node:
+	// lower_bound cut edges [i j]... next_child bound_count bounds...
+	// subtour_size cities...
+	out << "frontier " << checkpoint.frontier.size() << "\n";
+	for (size_t k = 0; k < checkpoint.frontier.size(); ++k) {
+		const Node &node = checkpoint.frontier[k];
+
+		out << node.lower_bound << " " << node.cut << " " << node.prohibited_edges.size();
+		for (size_t e = 0; e < node.prohibited_edges.size(); ++e) {
+			out << " " << node.prohibited_edges[e].first
+				<< " " << node.prohibited_edges[e].second;
+		}
+		out << " " << node.next_child << " " << node.child_bounds.size();
+		for (size_t b = 0; b < node.child_bounds.size(); ++b) {
+			out << " " << node.child_bounds[b];
+		}
+		out << " ";
+		checkpoint_write_list(out, node.subtours[node.chosen_subtour]);
+	}
+
+	out.close();
+	if (!out)
+		return false;
+
+	// the new file is on the disk before it replaces the previous
+	// one, and the rename is once its directory is
+	if (!checkpoint_sync(tmp_path) || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+		return false;
+
+	size_t slash = path.find_last_of('/');
+	return checkpoint_sync(slash == std::string::npos ? "." : path.substr(0, slash +1));
+}
+
+bool checkpoint_read (const std::string &path, Checkpoint &checkpoint) {
+	std::ifstream in(path, std::ios::in);
+
+	if (!in)
+		return false;
+
+	std::string word;
+	int version;
+
+	in >> word >> version;
+	if (word != CHECKPOINT_MAGIC || version < CHECKPOINT_MIN_VERSION || version > CHECKPOINT_VERSION)
+		return false;
+
+	in >> word >> checkpoint.search;
+	in >> word >> checkpoint.dimension;
+	in >> word >> checkpoint.upper_bound;
+	in >> word >> checkpoint.stats.expanded
+		>> checkpoint.stats.generated
+		>> checkpoint.stats.elapsed;
+	in >> word;
+	if (!in || !checkpoint_read_list(in, checkpoint.best_tour))
+		return false;
+
+	size_t frontier_size;
+	in >> word >> frontier_size;
+	if (!in)
+		return false;
+
+	checkpoint.frontier.clear();
+	checkpoint.frontier.reserve(frontier_size);
+
+	for (size_t k = 0; k < frontier_size; ++k) {
+		Node node;
+		size_t edges;
+
+		in >> node.lower_bound >> node.cut >> edges;
+		node.prohibited_edges.resize(edges);
+		for (size_t e = 0; e < edges; ++e) {
+			in >> node.prohibited_edges[e].first >> node.prohibited_edges[e].second;
+		}
+
+		node.next_child = 0;
+		if (version >= 2) {
+			size_t bounds = 0;
+
+			in >> node.next_child >> bounds;
+			node.child_bounds.resize(bounds);
+			for (size_t b = 0; b < bounds; ++b) {
+				in >> node.child_bounds[b];
+			}
+		}
+
+		node.subtours.resize(1);
+		node.chosen_subtour = 0;
+		if (!in || !checkpoint_read_list(in, node.subtours[0]))
+			return false;
+
+		checkpoint.frontier.push_back(node);
+	}
+
+	return true;
+}
+
+void checkpoint_writer_submit (CheckpointWriter &writer, Checkpoint &&checkpoint) {
+	checkpoint_writer_finish(writer);
+
+	std::string path = writer.path;
+	std::atomic<bool> *writing = &writer.writing;
+
+	writer.writing = true;
+	writer.worker = std::thread([path, writing](Checkpoint snapshot) {
+		if (!checkpoint_write(path, snapshot))
+			std::cerr << "Could not write checkpoint " << path << std::endl;
+
+		*writing = false;
+	}, std::move(checkpoint));
+}
+
+bool checkpoint_writer_busy (const CheckpointWriter &writer) {
+	return writer.writing;
+}
+
+void checkpoint_writer_finish (CheckpointWriter &writer) {
+	if (writer.worker.joinable())
+		writer.worker.join();
+}
@@ -0,0 +1,86 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string> // string
+#include <vector> // vector
+#include <thread> // thread
+#include <atomic> // atomic
+#include "tsp.h"
+#include "node.h"
+
+typedef struct s_checkpoint Checkpoint;
+
+struct s_checkpoint {
+	/**
+	 * Tree traversal method the saved search was using
+	 */
+	int search;
+
+	/**
+	 * Dimension of the instance, checked on resume
+	 */
+	int dimension;
+
+	double upper_bound;
+	std::vector<int> best_tour;
+	SearchStats stats;
+
+	/**
+	 * Open nodes in tree order, kept compact: only the prohibited
+	 * edges, the lower bound, the chosen subtour (the only one
+	 * needed to branch) and its children left are stored, so
+	 * `chosen_subtour` is always 0
+	 */
+	std::vector<Node> frontier;
+};
+
+/**
+ * Writes checkpoints on a background thread so that the search
+ * only pays for the snapshot of its frontier
+ *
+ * Each checkpoint is a full snapshot, not the nodes pushed and
+ * popped since the previous one: the search copies its whole
+ * frontier every time (see search_checkpoint for how long it may
+ * spend doing so).
+ */
+typedef struct s_checkpoint_writer {
+	std::string path;
+	std::thread worker;
+
+	/**
+	 * Set while `worker` is writing a checkpoint
+	 */
+	std::atomic<bool> writing {false};
+} CheckpointWriter;
+
+/**
+ * Appends the compact form of `node` to `checkpoint.frontier`
+ */
+void checkpoint_add_node (Checkpoint &checkpoint, const Node &node);
+
+/**
+ * Saves `checkpoint` to `path`, the file is replaced atomically
+ * and synced to the disk so that an interrupted write or a crash
+ * leaves the previous checkpoint intact
+ */
+bool checkpoint_write (const std::string &path, const Checkpoint &checkpoint);
+
+bool checkpoint_read (const std::string &path, Checkpoint &checkpoint);
+
+/**
+ * Hands `checkpoint` over to the writer thread, waiting for the
+ * previous write to finish first
+ */
+void checkpoint_writer_submit (CheckpointWriter &writer, Checkpoint &&checkpoint);
+
+/**
+ * Whether the previous checkpoint is still being written
+ */
+bool checkpoint_writer_busy (const CheckpointWriter &writer);
+
+/**
+ * Waits for the pending write, if any
+ */
+void checkpoint_writer_finish (CheckpointWriter &writer);
+
+#endif
@@ -0,0 +1,115 @@
+#include <algorithm> // copy
+#include "cost_matrix.h"
+
+template <typename Cost>
+BasicCostMatrix<Cost>::BasicCostMatrix():
+dimension(0),
+symmetric(false){
+}
+
+template <typename Cost>
+void BasicCostMatrix<Cost>::resize( int dimension, bool symmetric ){
+	this->dimension = dimension;
+	this->symmetric = symmetric;
+
+	size_t n = dimension;
+	values.assign( symmetric ? n * ( n + 1 ) / 2 : n * n, 0 );
+}
+
+template <typename Cost>
+void BasicCostMatrix<Cost>::pack(){
+	if ( symmetric )
+		return;
+
+	std::vector<Cost> full;
+	full.swap(values);
+
+	size_t n = dimension;
+	symmetric = true;
+	values.resize( n * ( n + 1 ) / 2 );
+
+	for ( int i = 0; i < dimension; i++ ) {
+		for ( int j = i; j < dimension; j++ ) {
+			values[index(i, j)] = full[(size_t) i * n + j];
+		}
+	}
+}
+
+template <typename Cost>
+void BasicCostMatrix<Cost>::getRow( int i, double *row ) const{
+	if ( !symmetric ) {
+		const Cost *full = &values[(size_t) i * dimension];
+		for ( int j = 0; j < dimension; j++ ) {
+			row[j] = full[j];
+		}
+		return;
+	}
+
+	// the part left of the diagonal is column i of the rows above
+	for ( int j = 0; j < i; j++ ) {
+		row[j] = values[index(j, i)];
+	}
+
+	const Cost *upper = &values[index(i, i)];
+	for ( int j = i; j < dimension; j++ ) {
+		row[j] = upper[j - i];
+	}
+}
+
+template <typename Cost>
+void BasicCostMatrix<Cost>::getFull( Cost *full ) const{
+	size_t n = dimension;
+
+	if ( !symmetric ) {
+		std::copy( values.begin(), values.end(), full );
+		return;
+	}
+
+	// each packed row fills a row of the upper part and the
+	// matching column of the lower one
+	const Cost *packed = values.data();
+	for ( size_t i = 0; i < n; i++ ) {
+		for ( size_t j = i; j < n; j++ ) {
+			Cost value = *packed++;
+			full[i * n + j] = value;
+			full[j * n + i] = value;
+		}
+	}
+}
+
+template <typename Cost>
+bool BasicCostMatrix<Cost>::checkSymmetric() const{
+	if ( symmetric )
+		return true;
+
+	for ( int i = 0; i < dimension; i++ ) {
+		for ( int j = i + 1; j < dimension; j++ ) {
+			if ( get(i, j) != get(j, i) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+template class BasicCostMatrix<double>;
+template class BasicCostMatrix<int>;
+
+double CostOverlay::get( const CostMatrix &base, int i, int j ) const{
+	for ( size_t k = entries.size(); k > 0; k-- ) {
+		const Entry &entry = entries[k - 1];
+		if ( entry.i == i && entry.j == j )
+			return entry.value;
+	}
+
+	return base.get(i, j);
+}
+
+void CostOverlay::getRow( const CostMatrix &base, int i, double *row ) const{
+	base.getRow(i, row);
+
+	for ( size_t k = 0; k < entries.size(); k++ ) {
+		if ( entries[k].i == i )
+			row[entries[k].j] = entries[k].value;
+	}
+}
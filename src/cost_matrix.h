@@ -0,0 +1,119 @@
+#ifndef COST_MATRIX_H
+#define COST_MATRIX_H
+
+#include <cstddef> // size_t
+#include <vector> // vector
+
+/**
+ * Square cost matrix, stored in full or, for symmetric instances,
+ * as a packed upper triangle (diagonal included) that takes half
+ * the memory. Both layouts are read through the same accessors.
+ */
+template <typename Cost>
+class BasicCostMatrix{
+public:
+	BasicCostMatrix();
+
+	void resize( int dimension, bool symmetric );
+
+	/**
+	 * Packs a full matrix whose entries turned out to be symmetric
+	 */
+	void pack();
+
+	inline int getDimension() const { return dimension; }
+	inline bool isSymmetric() const { return symmetric; }
+
+	inline Cost get( int i, int j ) const { return values[index(i, j)]; }
+
+	/**
+	 * In a symmetric matrix, setting (i, j) also sets (j, i)
+	 */
+	inline void set( int i, int j, Cost value ) { values[index(i, j)] = value; }
+
+	/**
+	 * Copies row i into `row`, which holds `dimension` values
+	 */
+	void getRow( int i, double *row ) const;
+
+	/**
+	 * Copies the whole matrix into `full`, which holds `dimension`
+	 * x `dimension` values, in full and row-major
+	 */
+	void getFull( Cost *full ) const;
+
+	/**
+	 * Checks whether every (i, j) equals (j, i)
+	 */
+	bool checkSymmetric() const;
+
+	inline size_t getBytes() const { return values.size() * sizeof(Cost); }
+
+private:
+	int dimension;
+	bool symmetric;
+	std::vector<Cost> values;
+
+	inline size_t index( int i, int j ) const {
+		if ( !symmetric )
+			return (size_t) i * dimension + j;
+
+		if ( i > j ) {
+			int k = i;
+			i = j;
+			j = k;
+		}
+
+		// rows above i hold dimension, dimension-1, ... entries
+		return (size_t) i * ( 2 * (size_t) dimension - i + 1 ) / 2 + ( j - i );
+	}
+};
+
+/**
+ * Instance costs, as read from the instance
+ */
+typedef BasicCostMatrix<double> CostMatrix;
+
+/**
+ * Instance costs converted to the integers the assignment solvers
+ * work on, in the same layout (see tsp_prepare)
+ */
+typedef BasicCostMatrix<int> SolverCosts;
+
+/**
+ * Sparse set of entries that override a CostMatrix, used to
+ * prohibit edges without copying or touching the shared matrix.
+ * Entries behave as a stack: the latest one set for an (i, j)
+ * wins, and pop() undoes the latest one.
+ */
+class CostOverlay{
+public:
+	struct Entry {
+		int i;
+		int j;
+		double value;
+	};
+
+	inline void set( int i, int j, double value ) { entries.push_back(Entry{ i, j, value }); }
+	inline void pop() { entries.pop_back(); }
+	inline void clear() { entries.clear(); }
+	inline size_t size() const { return entries.size(); }
+
+	/**
+	 * k-th entry set, applying them in order gives the overridden
+	 * costs (e.g. to patch a copy of the matrix)
+	 */
+	inline const Entry &getEntry( size_t k ) const { return entries[k]; }
+
+	double get( const CostMatrix &base, int i, int j ) const;
+
+	/**
+	 * Row i of `base` with the overriding entries applied
+	 */
+	void getRow( const CostMatrix &base, int i, double *row ) const;
+
+private:
+	std::vector<Entry> entries;
+};
+
+#endif
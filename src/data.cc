@@ -3,7 +3,6 @@
 
 //Inicializador
 Data::Data( int qtParam, char * instance ):
-distMatrix(NULL),
 xCoord(NULL),
 yCoord(NULL){
 
@@ -28,134 +27,183 @@ yCoord(NULL){
 Data::~Data(){
 	delete [] xCoord;
 	delete [] yCoord;
+}
+
+bool Data::seek( ifstream &inTSP, const string &key, bool field ){
+
+	string file;
 
-	for ( int i = 0; i < dimension; i++){
-		delete [] distMatrix[i];
+	while ( inTSP >> file ) {
+		if ( file == key + ":" )
+			return true;
+
+		if ( file == key ) {
+			// "KEY : value"
+			if ( field ) inTSP >> file;
+			return bool( inTSP );
+		}
 	}
-	delete [] distMatrix;
+
+	return false;
 }
 
-void Data::readData(){
-
-	ifstream inTSP(instaceName, ios::in);
+bool Data::readHeader( ifstream &inTSP, string &typeProblem, string &error ){
 
 	if ( !inTSP ){
-		cout << "File not found" << endl;
-		exit(EXIT_FAILURE);
+		error = "Could not open instance " + instaceName;
+		return false;
 	}
 
-	string file, typeProblem;   //They are used into the reader
+	if ( !seek( inTSP, "DIMENSION", true ) || !( inTSP >> dimension ) || dimension < 1 ) {
+		error = "Instance " + instaceName + " has no valid DIMENSION";
+		return false;
+	}
 
-	while ( file.compare("DIMENSION:") != 0 && file.compare("DIMENSION" ) != 0 ) {
-		inTSP >> file;
+	if ( !seek( inTSP, "EDGE_WEIGHT_TYPE", true ) || !( inTSP >> typeProblem ) ) {
+		error = "Instance " + instaceName + " has no EDGE_WEIGHT_TYPE";
+		return false;
 	}
 
-	if ( file.compare("DIMENSION" ) == 0 )  inTSP >> file;
+	delete [] xCoord;
+	delete [] yCoord;
+	xCoord = new double [ dimension ]; //coord x
+	yCoord = new double [ dimension ]; //coord y
 
-	inTSP >> dimension; // valor depois do string "DIMENSION:" é a dimensão do problema
+	return true;
+}
 
-	while ( file.compare("EDGE_WEIGHT_TYPE:") != 0 && file.compare("EDGE_WEIGHT_TYPE" ) != 0 ) {
-		inTSP >> file;
-	}
-	if ( file.compare("EDGE_WEIGHT_TYPE" ) == 0 )  inTSP >> file;
+void Data::readCoordinates(){
 
-	inTSP >> typeProblem; //EDGE_WEIGHT_TYPE
+	ifstream inTSP(instaceName, ios::in);
 
-	xCoord = new double [ dimension ]; //coord x
-	yCoord = new double [ dimension ]; //coord y
+	string typeProblem, error;
+
+	if ( !readHeader( inTSP, typeProblem, error ) )
+		return;
+
+	if ( typeProblem != "EUC_2D" && typeProblem != "CEIL_2D"
+			&& typeProblem != "GEO" && typeProblem != "ATT" )
+		return;
 
-	// Alocar matriz 2D
-	distMatrix = new double *[ dimension ]; //memoria dinâmica (matrix 2D)
+	if ( !seek( inTSP, "NODE_COORD_SECTION", false ) )
+		return;
 
+	int tempCity;
 	for ( int i = 0; i < dimension; i++ ) {
-		distMatrix[i] = new double [ dimension ];
+		inTSP >> tempCity >> xCoord[i] >> yCoord[i];
 	}
 
-	if ( typeProblem == "EXPLICIT" ) {
+	explicitCoord = bool( inTSP );
+}
 
-		while ( file.compare("EDGE_WEIGHT_FORMAT:") != 0 && file.compare("EDGE_WEIGHT_FORMAT" ) != 0 ) {
-			inTSP >> file;
-		}
+void Data::readData(){
+
+	string error;
+
+	if ( !loadData( error ) ) {
+		cout << error << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+bool Data::loadData( string &error ){
+
+	ifstream inTSP(instaceName, ios::in);
+
+	string typeProblem;
+
+	if ( !readHeader( inTSP, typeProblem, error ) )
+		return false;
+
+	// Every supported format but FULL_MATRIX is symmetric and gets
+	// the packed (upper triangular) storage
+	distMatrix.resize( dimension, true );
+
+	double distance;
+
+	if ( typeProblem == "EXPLICIT" ) {
 
 		string ewf;
 
-		if ( file.compare("EDGE_WEIGHT_FORMAT" ) == 0 )  inTSP >> file;
-		inTSP >> ewf;
+		if ( !seek( inTSP, "EDGE_WEIGHT_FORMAT", true ) || !( inTSP >> ewf ) ) {
+			error = "Instance " + instaceName + " has no EDGE_WEIGHT_FORMAT";
+			return false;
+		}
+
+		if ( ewf != "FULL_MATRIX" && ewf != "UPPER_ROW" && ewf != "LOWER_ROW"
+				&& ewf != "UPPER_DIAG_ROW" && ewf != "LOWER_DIAG_ROW" && ewf != "UPPER_COL"
+				&& ewf != "LOWER_COL" && ewf != "UPPER_DIAG_COL" && ewf != "LOWER_DIAG_COL" ) {
+			error = "EDGE_WEIGHT_FORMAT " + ewf + " is not supported";
+			return false;
+		}
 
-		if ( ewf == "FUNCTION" ) {
-			cout << "FUNCTION - Nao suportado!" << endl; }
+		if ( !seek( inTSP, "EDGE_WEIGHT_SECTION", false ) ) {
+			error = "Instance " + instaceName + " has no EDGE_WEIGHT_SECTION";
+			return false;
+		}
 
-		else if ( ewf == "FULL_MATRIX" ) {
+		if ( ewf == "FULL_MATRIX" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
+			distMatrix.resize( dimension, false );
 
 			// Preencher Matriz Distancia
 			for ( int i = 0; i < dimension; i++ ) {
 				for ( int j = 0; j < dimension; j++ ) {
-					inTSP >> distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 					if (i == j){
-						distMatrix[i][j] = INFINITE;
+						distMatrix.set( i, j, INFINITE );
 					}
 				}
 			}
+
+			if ( distMatrix.checkSymmetric() ) {
+				distMatrix.pack();
+			}
 		}
 
 		else if ( ewf == "UPPER_ROW" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int i = 0; i < dimension; i++ ) {
 				for ( int j = i + 1; j < dimension; j++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 				}
 			}
 
 			for ( int i = 0; i < dimension; i++ ) {
 				//                distMatrix[i][i] = 0;
-				distMatrix[i][i] = INFINITE;
+				distMatrix.set( i, i, INFINITE );
 			}
 		}
 
 		else if ( ewf == "LOWER_ROW" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int i = 1; i < dimension; i++ ) {
 				for ( int j = 0; j < i; j++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 				}
 			}
 
 			for ( int i = 0; i < dimension; i++ ) {
 				//                distMatrix[i][i] = 0;
-				distMatrix[i][i] = INFINITE;
+				distMatrix.set( i, i, INFINITE );
 			}
 		}
 
 		else if ( ewf == "UPPER_DIAG_ROW" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int i = 0; i < dimension; i++ ) {
 				for ( int j = i; j < dimension; j++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 
 					if (i == j){
-						distMatrix[i][j] = INFINITE;
+						distMatrix.set( i, j, INFINITE );
 					}
 				}
 			}
@@ -163,18 +211,14 @@ void Data::readData(){
 
 		else if ( ewf == "LOWER_DIAG_ROW" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int i = 0; i < dimension; i++ ) {
 				for ( int j = 0; j <= i; j++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 
 					if (i == j){
-						distMatrix[i][j] = INFINITE;
+						distMatrix.set( i, j, INFINITE );
 					}
 				}
 			}
@@ -182,59 +226,47 @@ void Data::readData(){
 
 		else if ( ewf == "UPPER_COL" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int j = 1; j < dimension; j++ ) {
 				for ( int i = 0; i < j; i++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 				}
 			}
 
 			for ( int i = 0; i < dimension; i++ ) {
 				//                distMatrix[i][i] = 0;
-				distMatrix[i][i] = INFINITE;
+				distMatrix.set( i, i, INFINITE );
 			}
 
 		}
 
 		else if ( ewf == "LOWER_COL" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int j = 0; j < dimension; j++ ) {
-				for ( int i = j+1; i < dimension; j++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+				for ( int i = j+1; i < dimension; i++ ) {
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 				}
 			}
 
 			for ( int i = 0; i < dimension; i++ ) {
 				//                distMatrix[i][i] = 0;
-				distMatrix[i][i] = INFINITE;
+				distMatrix.set( i, i, INFINITE );
 			}
 
 		}
 
 		else if ( ewf == "UPPER_DIAG_COL" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int j = 0; j < dimension; j++ ) {
 				for ( int i = 0; i <= j; i++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 					if (i == j){
-						distMatrix[i][j] = INFINITE;
+						distMatrix.set( i, j, INFINITE );
 					}
 				}
 			}
@@ -242,18 +274,14 @@ void Data::readData(){
 
 		else if ( ewf == "LOWER_DIAG_COL" ) {
 
-			while ( file.compare("EDGE_WEIGHT_SECTION") != 0 ) {
-				inTSP >> file;
-			}
-
 			// Preencher Matriz Distancia
 			for ( int j = 0; j < dimension; j++ ) {
-				for ( int i = j; i < dimension; j++ ) {
-					inTSP >> distMatrix[i][j];
-					distMatrix[j][i] = distMatrix[i][j];
+				for ( int i = j; i < dimension; i++ ) {
+					inTSP >> distance;
+					distMatrix.set( i, j, distance );
 
 					if (i == j){
-						distMatrix[i][j] = INFINITE;
+						distMatrix.set( i, j, INFINITE );
 					}
 				}
 			}
@@ -266,8 +294,9 @@ void Data::readData(){
 
 		explicitCoord = true;
 
-		while ( file.compare("NODE_COORD_SECTION") != 0 ) {
-			inTSP >> file;
+		if ( !seek( inTSP, "NODE_COORD_SECTION", false ) ) {
+			error = "Instance " + instaceName + " has no NODE_COORD_SECTION";
+			return false;
 		}
 		// ler coordenadas
 		int tempCity;
@@ -277,36 +306,22 @@ void Data::readData(){
 
 		// Calcular Matriz Distancia (Euclidiana)
 		for ( int i = 0; i < dimension; i++ ) {
-			for ( int j = 0; j < dimension; j++ ) {
-				distMatrix[i][j] = floor ( CalcDistEuc ( xCoord, yCoord, i, j ) + 0.5 );
+			for ( int j = i; j < dimension; j++ ) {
+				distMatrix.set( i, j, floor ( CalcDistEuc ( xCoord, yCoord, i, j ) + 0.5 ) );
 
 				if (i == j){
-					distMatrix[i][j] = INFINITE;
+					distMatrix.set( i, j, INFINITE );
 				}
 			}
 		}
 	}
 
-	else if ( typeProblem == "EUD_3D" ) {
-		cout << "EUC_3D - Nao suportado!" << endl; }
-
-	else if ( typeProblem == "MAX_2D" ) {
-		cout << "MAX_2D - Nao suportado!" << endl; }
-
-	else if ( typeProblem == "MAX_3D" ) {
-		cout << "MAX_3D - Nao Suportado!" << endl; }
-
-	else if ( typeProblem == "MAN_2D" ) {
-		cout << "MAN_2D - Nao suportado!" << endl; }
-
-	else if ( typeProblem == "MAN_3D" ) {
-		cout << "MAN_3D - Nao Suportado!" << endl; }
-
 	else if ( typeProblem == "CEIL_2D" ) {
 
 		explicitCoord = true;
-		while ( file.compare("NODE_COORD_SECTION") != 0 ) {
-			inTSP >> file;
+		if ( !seek( inTSP, "NODE_COORD_SECTION", false ) ) {
+			error = "Instance " + instaceName + " has no NODE_COORD_SECTION";
+			return false;
 		}
 		// ler coordenadas
 		int tempCity;
@@ -316,11 +331,11 @@ void Data::readData(){
 
 		// Calcular Matriz Distancia (Euclidiana)
 		for ( int i = 0; i < dimension; i++ ) {
-			for ( int j = 0; j < dimension; j++ ) {
-				distMatrix[i][j] = ceil ( CalcDistEuc ( xCoord, yCoord, i, j ) );
+			for ( int j = i; j < dimension; j++ ) {
+				distMatrix.set( i, j, ceil ( CalcDistEuc ( xCoord, yCoord, i, j ) ) );
 
 				if (i == j){
-					distMatrix[i][j] = INFINITE;
+					distMatrix.set( i, j, INFINITE );
 				}
 			}
 		}
@@ -330,8 +345,9 @@ void Data::readData(){
 
 		explicitCoord = true;
 
-		while ( file.compare("NODE_COORD_SECTION") != 0 ) { //enquanto nao achar o string "NODE_COORD_SECTION" faça
-			inTSP >> file;
+		if ( !seek( inTSP, "NODE_COORD_SECTION", false ) ) {
+			error = "Instance " + instaceName + " has no NODE_COORD_SECTION";
+			return false;
 		}
 		// ler coordenadas
 		int tempCity; //numero da cidade
@@ -346,11 +362,11 @@ void Data::readData(){
 
 		// Calcular Matriz Distancia
 		for ( int i = 0; i < dimension; i++ ) {
-			for ( int j = 0; j < dimension; j++ ) {
-				distMatrix[i][j] = CalcDistGeo ( latitude, longitude, i, j );
+			for ( int j = i; j < dimension; j++ ) {
+				distMatrix.set( i, j, CalcDistGeo ( latitude, longitude, i, j ) );
 
 				if (i == j){
-					distMatrix[i][j] = INFINITE;
+					distMatrix.set( i, j, INFINITE );
 				}
 			}
 		}
@@ -364,8 +380,9 @@ void Data::readData(){
 
 		explicitCoord = true;
 
-		while ( file.compare("NODE_COORD_SECTION") != 0 ) {
-			inTSP >> file;
+		if ( !seek( inTSP, "NODE_COORD_SECTION", false ) ) {
+			error = "Instance " + instaceName + " has no NODE_COORD_SECTION";
+			return false;
 		}
 
 		// ler coordenadas
@@ -381,11 +398,11 @@ void Data::readData(){
 
 		// Calcular Matriz Distancia (Pesudo-Euclidiana)
 		for ( int i = 0; i < dimension; i++ ) {
-			for ( int j = 0; j < dimension; j++ ) {
-				distMatrix[i][j] = CalcDistAtt ( xCoord, yCoord, i, j );
+			for ( int j = i; j < dimension; j++ ) {
+				distMatrix.set( i, j, CalcDistAtt ( xCoord, yCoord, i, j ) );
 
 				if (i == j){
-					distMatrix[i][j] = INFINITE;
+					distMatrix.set( i, j, INFINITE );
 				}
 			}
 		}
@@ -395,15 +412,17 @@ void Data::readData(){
 
 	}
 
-	else if ( typeProblem == "XRAY1" ) {
-		cout << "XRAY1 - Nao suportado!" << endl; }
-
-	else if ( typeProblem == "XRAY2" ) {
-		cout << "XRAY2 - Nao suportado!" << endl; }
+	else {
+		error = "EDGE_WEIGHT_TYPE " + typeProblem + " is not supported";
+		return false;
+	}
 
-	else if ( typeProblem == "SPECIAL" ) {
-		cout << "SPECIAL - Nao suportado!" << endl; }
+	if ( !inTSP ) {
+		error = "Instance " + instaceName + " is truncated or has a malformed entry";
+		return false;
+	}
 
+	return true;
 }
 
 double Data::CalcDistEuc ( double *X, double *Y, int I, int J ){
@@ -7,6 +7,7 @@
 #include <vector>
 #include <cmath>
 #include <math.h>
+#include "cost_matrix.h"
 using namespace std;
 
 #define INFINITE 99999999
@@ -17,10 +18,18 @@ public:
 	~Data();
 
 	void readData();
+
+	// Same as readData, but a file that can't be parsed gives false
+	// and a message in `error` instead of ending the process
+	bool loadData( string &error );
+
+	// Reads only the dimension and, for the formats that have them,
+	// the coordinates: no distance matrix is built
+	void readCoordinates();
 	void printMatrixDist();
 	inline int getDimension(){ return dimension; };
-	inline double getDistance(int i, int j){return distMatrix[i][j]; };
-	inline double **getMatrixCost(){return distMatrix; }
+	inline double getDistance(int i, int j){return distMatrix.get(i, j); };
+	inline CostMatrix &getMatrixCost(){return distMatrix; }
 	inline double getXCoord(int i){return xCoord[i];}
 	inline double getYCoord(int i){return yCoord[i];}
 	inline bool getExplicitCoord(){return explicitCoord; };
@@ -33,9 +42,15 @@ private:
 
 	int dimension;
 
-	double **distMatrix;
+	CostMatrix distMatrix;
 	double *xCoord, *yCoord;
 
+	bool readHeader( ifstream &, string &, string & );
+
+	// Skips past the token `key` (or "key:"), and past the ":" after
+	// it when `field`, false at the end of the file
+	bool seek( ifstream &, const string &, bool );
+
 	//Computing Distances
 	static double CalcDistEuc ( double *, double *, int , int );
 	static double CalcDistAtt ( double *, double *, int , int );
@@ -0,0 +1,289 @@
+#include <vector> // vector
+#include <thread> // thread
+#include <algorithm> // min, max
+#include <cstdint> // uint32_t
+#include <unistd.h> // sysconf
+#include "held_karp.h"
+#include "data.h" // INFINITE
+
+// bound of the entries of the table, two of them add up without
+// overflowing
+#define HELD_KARP_INF 0x3FFFFFFF
+
+// subsets a thread of the sweep takes at least
+#define HELD_KARP_CHUNK 4096
+
+/**
+ * Dynamic programming over the subsets of the cities but the first
+ * (city j +1 is bit j), for instances of up to `Width` cities
+ *
+ * The table has a row of `Width` entries per subset, entry j being
+ * the cost of the cheapest path from the first city through the
+ * subset that ends at city j +1, HELD_KARP_INF when j isn't in the
+ * subset. A fixed row width turns the minimum over the predecessors
+ * into a loop of constant length, which the compiler unrolls and
+ * vectorizes.
+ */
+template <int Width>
+struct HeldKarp {
+	int cities;
+
+	std::vector<int> table;
+
+	/**
+	 * into[j * Width + k]: cost of the arc from city k +1 to city
+	 * j +1, HELD_KARP_INF for the padding
+	 */
+	std::vector<int> into;
+	std::vector<int> from_first;
+	std::vector<int> to_first;
+
+	/**
+	 * Subsets by increasing size, those of size p start at
+	 * layer[p]
+	 */
+	std::vector<uint32_t> order;
+	std::vector<size_t> layer;
+};
+
+static int held_karp_cost (double cost) {
+	// truncated, as the assignment solvers do
+	int value = cost;
+	return std::min(value, HELD_KARP_INF);
+}
+
+template <int Width>
+static void held_karp_init (HeldKarp<Width> &hk, int dimension,
+		hungarian_row_fn fill_row, void *ctx) {
+	int cities = dimension -1;
+	hk.cities = cities;
+
+	hk.into.assign(Width * Width, HELD_KARP_INF);
+	hk.from_first.assign(Width, HELD_KARP_INF);
+	hk.to_first.assign(Width, HELD_KARP_INF);
+
+	std::vector<double> row (dimension);
+
+	for (int i = 0; i < dimension; ++i) {
+		fill_row(ctx, i, row.data());
+
+		if (i == 0) {
+			for (int j = 0; j < cities; ++j) {
+				hk.from_first[j] = held_karp_cost(row[j +1]);
+			}
+			continue;
+		}
+
+		hk.to_first[i -1] = held_karp_cost(row[0]);
+		for (int j = 0; j < cities; ++j) {
+			if (j != i -1)
+				hk.into[j * Width + i -1] = held_karp_cost(row[j +1]);
+		}
+	}
+
+	// counting sort of the subsets by size
+	uint32_t subsets = 1u << cities;
+	hk.layer.assign(cities +2, 0);
+
+	for (uint32_t subset = 0; subset < subsets; ++subset) {
+		++hk.layer[__builtin_popcount(subset) +1];
+	}
+	for (int p = 1; p <= cities +1; ++p) {
+		hk.layer[p] += hk.layer[p -1];
+	}
+
+	std::vector<size_t> next (hk.layer.begin(), hk.layer.end() -1);
+	hk.order.resize(subsets);
+
+	for (uint32_t subset = 0; subset < subsets; ++subset) {
+		hk.order[next[__builtin_popcount(subset)]++] = subset;
+	}
+
+	hk.table.resize((size_t) subsets * Width);
+}
+
+/**
+ * Fills the row of `subset`, from the rows of its subsets with one
+ * city less
+ */
+template <int Width>
+static void held_karp_row (HeldKarp<Width> &hk, uint32_t subset) {
+	int *row = &hk.table[(size_t) subset * Width];
+
+	for (int j = 0; j < Width; ++j) {
+		uint32_t bit = 1u << j;
+
+		if (!(subset & bit)) {
+			row[j] = HELD_KARP_INF;
+			continue;
+		}
+
+		if (subset == bit) {
+			row[j] = hk.from_first[j];
+			continue;
+		}
+
+		const int *prev = &hk.table[(size_t) (subset ^ bit) * Width];
+		const int *into = &hk.into[j * Width];
+		int best = HELD_KARP_INF;
+
+		for (int k = 0; k < Width; ++k) {
+			best = std::min(best, prev[k] + into[k]);
+		}
+
+		row[j] = best;
+	}
+}
+
+template <int Width>
+static void held_karp_rows (HeldKarp<Width> *hk, size_t first, size_t last) {
+	for (size_t i = first; i < last; ++i) {
+		held_karp_row(*hk, hk->order[i]);
+	}
+}
+
+/**
+ * Fills the table one subset size at a time, the subsets of a same
+ * size being split among the threads
+ */
+template <int Width>
+static void held_karp_sweep (HeldKarp<Width> &hk, int threads) {
+	std::vector<std::thread> workers;
+
+	for (int p = 1; p <= hk.cities; ++p) {
+		size_t first = hk.layer[p];
+		size_t last = hk.layer[p +1];
+		size_t count = last - first;
+
+		size_t parts = std::max((size_t) 1, std::min((size_t) threads, count / HELD_KARP_CHUNK));
+		size_t chunk = (count + parts -1) / parts;
+
+		workers.clear();
+		for (size_t t = 1; t < parts; ++t) {
+			size_t from = first + t * chunk;
+			workers.push_back(std::thread(held_karp_rows<Width>, &hk,
+				from, std::min(last, from + chunk)));
+		}
+
+		held_karp_rows(&hk, first, std::min(last, first + chunk));
+
+		for (size_t t = 0; t < workers.size(); ++t) {
+			workers[t].join();
+		}
+	}
+}
+
+/**
+ * Closes the cheapest path through every city into a tour, and
+ * follows the table back to write it
+ */
+template <int Width>
+static double held_karp_tour (HeldKarp<Width> &hk, std::vector<int> &tour) {
+	uint32_t subset = (1u << hk.cities) -1;
+	const int *row = &hk.table[(size_t) subset * Width];
+
+	long long cost = INFINITE;
+	int last = -1;
+
+	for (int j = 0; j < hk.cities; ++j) {
+		long long length = (long long) row[j] + hk.to_first[j];
+
+		if (length < cost) {
+			cost = length;
+			last = j;
+		}
+	}
+
+	tour.clear();
+	if (last < 0 || cost >= INFINITE)
+		return INFINITE;
+
+	std::vector<int> path;
+	int city = last;
+
+	while (subset != (1u << city)) {
+		uint32_t prev = subset ^ (1u << city);
+		int value = hk.table[(size_t) subset * Width + city];
+		const int *prev_row = &hk.table[(size_t) prev * Width];
+		const int *into = &hk.into[city * Width];
+
+		path.push_back(city);
+		subset = prev;
+
+		for (int k = 0; k < hk.cities; ++k) {
+			if (prev_row[k] + into[k] == value) {
+				city = k;
+				break;
+			}
+		}
+	}
+	path.push_back(city);
+
+	tour.push_back(1);
+	for (size_t k = path.size(); k > 0; --k) {
+		tour.push_back(path[k -1] +2);
+	}
+	tour.push_back(1);
+
+	return cost;
+}
+
+template <int Width>
+static double held_karp_run (int dimension, hungarian_row_fn fill_row, void *ctx,
+		int threads, std::vector<int> &tour) {
+	HeldKarp<Width> hk;
+
+	held_karp_init(hk, dimension, fill_row, ctx);
+	held_karp_sweep(hk, threads);
+
+	return held_karp_tour(hk, tour);
+}
+
+/**
+ * Row width of the table for `dimension` cities, 0 when it is too
+ * large
+ */
+static int held_karp_width (int dimension) {
+	if (dimension < 2 || dimension > HELD_KARP_MAX)
+		return 0;
+
+	return dimension <= 16 ? 16 : dimension <= 20 ? 20 : 24;
+}
+
+size_t held_karp_memory (int dimension) {
+	size_t width = held_karp_width(dimension);
+
+	if (!width)
+		return 0;
+
+	size_t subsets = (size_t) 1 << (dimension -1);
+	return subsets * (width * sizeof(int) + sizeof(uint32_t));
+}
+
+size_t held_karp_memory_limit () {
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long page_size = sysconf(_SC_PAGE_SIZE);
+
+	// unknown, only the allocation can tell
+	if (pages <= 0 || page_size <= 0)
+		return (size_t) -1;
+
+	return (size_t) pages * page_size / 2;
+}
+
+double held_karp_solve (int dimension, hungarian_row_fn fill_row, void *ctx,
+		int threads, std::vector<int> &tour) {
+	threads = std::max(threads, 1);
+
+	switch (held_karp_width(dimension)) {
+	case 16:
+		return held_karp_run<16>(dimension, fill_row, ctx, threads, tour);
+	case 20:
+		return held_karp_run<20>(dimension, fill_row, ctx, threads, tour);
+	case 24:
+		return held_karp_run<24>(dimension, fill_row, ctx, threads, tour);
+	}
+
+	tour.clear();
+	return INFINITE;
+}
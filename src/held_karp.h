@@ -0,0 +1,42 @@
+#ifndef HELD_KARP_H
+#define HELD_KARP_H
+
+#include <vector> // vector
+#include "hungarian.h" // hungarian_row_fn
+
+// largest dimension held_karp_solve() handles
+#define HELD_KARP_MAX 24
+
+/**
+ * Bytes held_karp_solve() allocates for an instance of `dimension`
+ * cities, 0 when it is too large
+ */
+size_t held_karp_memory (int dimension);
+
+/**
+ * Bytes the table may take at most: half of the physical memory, so
+ * that a table the system would only pretend to give (and kill the
+ * process on touching) is never asked for
+ */
+size_t held_karp_memory_limit ();
+
+/**
+ * Solves the instance of `dimension` cities (2 to HELD_KARP_MAX)
+ * exactly, by Held and Karp's dynamic programming over the subsets
+ * of cities: the cost of the cheapest path from the first city
+ * through a subset, ending at each city of it
+ *
+ * Costs are read row by row through `fill_row`, and truncated to
+ * integers as the assignment solvers do, so the prohibited edges of
+ * a node apply when it is given node_cost_row. The subsets of a same
+ * size are independent and split among `threads` threads.
+ *
+ * Writes the tour to `tour` (1 based and closed, from the first
+ * city) and returns its cost, INFINITE when every tour has to use
+ * an arc that can't be used. Throws std::bad_alloc when the table
+ * doesn't fit in memory.
+ */
+double held_karp_solve (int dimension, hungarian_row_fn fill_row, void *ctx,
+	int threads, std::vector<int> &tour);
+
+#endif
@@ -25,6 +25,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <vector>
 #include "hungarian.h"
 #include "data.h"
 
@@ -69,35 +71,266 @@ int hungarian_imax(int a, int b) {
   return (a<b)?b:a;
 }
 
+/********************************************************************
+ ** Kernels of the solver hot loops
+ **
+ ** Each one has a scalar version and an AVX2 version, the latter
+ ** is compiled through the target attribute and picked at run time
+ ** when the CPU supports it, so the build flags stay portable.
+ ********************************************************************/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HUNGARIAN_AVX2 1
+#include <immintrin.h>
+#else
+#define HUNGARIAN_AVX2 0
+#endif
+
+static int hungarian_has_avx2() {
+#if HUNGARIAN_AVX2
+  static const int has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+#else
+  return 0;
+#endif
+}
+
+// col_min[l] = min over the rows of cost[k][l], taken row by row
+// instead of walking down the columns
+static void hungarian_column_min_scalar(int** cost, int m, int n, int* col_min) {
+  int k, l;
+  for (l=0;l<n;l++)
+    col_min[l]=cost[0][l];
+  for (k=1;k<m;k++) {
+    const int* row=cost[k];
+    for (l=0;l<n;l++)
+      if (row[l]<col_min[l])
+        col_min[l]=row[l];
+  }
+}
+
+// Updates slack with row k of the forest, del = cost[k][l] - s + col_inc[l].
+// Columns where del improves a nonzero slack get slack = del and
+// slack_row = k, except those where del is zero: these are written to
+// `zeros` in increasing order and left for the caller, who has to look
+// at them one by one. Returns the number of zeros found.
+static int hungarian_explore_row_scalar(const int* cost_row, int s, int k, int n,
+    const int* col_inc, int* slack, int* slack_row, int* zeros) {
+  int l, del, z;
+  z=0;
+  for (l=0;l<n;l++)
+    if (slack[l])
+      {
+        del=cost_row[l]-s+col_inc[l];
+        if (del<slack[l])
+          {
+            if (del==0)
+              zeros[z++]=l;
+            else
+              {
+                slack[l]=del;
+                slack_row[l]=k;
+              }
+          }
+      }
+  return z;
+}
+
+// Smallest nonzero slack, INF when every column is covered
+static int hungarian_slack_min_scalar(const int* slack, int n) {
+  int l, s;
+  s=INF;
+  for (l=0;l<n;l++)
+    if (slack[l] && slack[l]<s)
+      s=slack[l];
+  return s;
+}
+
+#if HUNGARIAN_AVX2
+__attribute__((target("avx2")))
+static void hungarian_column_min_avx2(int** cost, int m, int n, int* col_min) {
+  int k, l;
+  for (l=0;l<n;l++)
+    col_min[l]=cost[0][l];
+  for (k=1;k<m;k++) {
+    const int* row=cost[k];
+    for (l=0;l+8<=n;l+=8) {
+      __m256i c=_mm256_loadu_si256((const __m256i*)(row+l));
+      __m256i v=_mm256_loadu_si256((const __m256i*)(col_min+l));
+      _mm256_storeu_si256((__m256i*)(col_min+l), _mm256_min_epi32(c,v));
+    }
+    for (;l<n;l++)
+      if (row[l]<col_min[l])
+        col_min[l]=row[l];
+  }
+}
+
+__attribute__((target("avx2")))
+static int hungarian_explore_row_avx2(const int* cost_row, int s, int k, int n,
+    const int* col_inc, int* slack, int* slack_row, int* zeros) {
+  int l, z, mask, lane;
+  const __m256i zero=_mm256_setzero_si256();
+  const __m256i sv=_mm256_set1_epi32(s);
+  const __m256i kv=_mm256_set1_epi32(k);
+  z=0;
+  for (l=0;l+8<=n;l+=8) {
+    __m256i c=_mm256_loadu_si256((const __m256i*)(cost_row+l));
+    __m256i inc=_mm256_loadu_si256((const __m256i*)(col_inc+l));
+    __m256i sl=_mm256_loadu_si256((const __m256i*)(slack+l));
+    __m256i del=_mm256_add_epi32(_mm256_sub_epi32(c,sv),inc);
+
+    // lanes with a nonzero slack that del improves
+    __m256i better=_mm256_andnot_si256(_mm256_cmpeq_epi32(sl,zero),
+                                       _mm256_cmpgt_epi32(sl,del));
+    if (_mm256_testz_si256(better,better))
+      continue;
+
+    __m256i is_zero=_mm256_cmpeq_epi32(del,zero);
+    __m256i update=_mm256_andnot_si256(is_zero,better);
+    _mm256_storeu_si256((__m256i*)(slack+l), _mm256_blendv_epi8(sl,del,update));
+    __m256i sr=_mm256_loadu_si256((const __m256i*)(slack_row+l));
+    _mm256_storeu_si256((__m256i*)(slack_row+l), _mm256_blendv_epi8(sr,kv,update));
+
+    mask=_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(is_zero,better)));
+    while (mask) {
+      lane=__builtin_ctz(mask);
+      zeros[z++]=l+lane;
+      mask&=mask-1;
+    }
+  }
+  // the remaining columns, their zeros are offset back by l
+  lane=hungarian_explore_row_scalar(cost_row+l,s,k,n-l,col_inc+l,slack+l,slack_row+l,zeros+z);
+  while (lane--)
+    zeros[z++]+=l;
+  return z;
+}
+
+__attribute__((target("avx2")))
+static int hungarian_slack_min_avx2(const int* slack, int n) {
+  int l, s;
+  const __m256i zero=_mm256_setzero_si256();
+  const __m256i inf=_mm256_set1_epi32(INF);
+  __m256i best=inf;
+  for (l=0;l+8<=n;l+=8) {
+    __m256i sl=_mm256_loadu_si256((const __m256i*)(slack+l));
+    // covered columns (zero slack) must not take part
+    sl=_mm256_blendv_epi8(sl,inf,_mm256_cmpeq_epi32(sl,zero));
+    best=_mm256_min_epi32(best,sl);
+  }
+  __m128i half=_mm_min_epi32(_mm256_castsi256_si128(best),_mm256_extracti128_si256(best,1));
+  half=_mm_min_epi32(half,_mm_shuffle_epi32(half,_MM_SHUFFLE(1,0,3,2)));
+  half=_mm_min_epi32(half,_mm_shuffle_epi32(half,_MM_SHUFFLE(2,3,0,1)));
+  s=_mm_cvtsi128_si32(half);
+  for (;l<n;l++)
+    if (slack[l] && slack[l]<s)
+      s=slack[l];
+  return s;
+}
+#endif
+
+static void hungarian_column_min(int** cost, int m, int n, int* col_min) {
+#if HUNGARIAN_AVX2
+  if (hungarian_has_avx2()) {
+    hungarian_column_min_avx2(cost,m,n,col_min);
+    return;
+  }
+#endif
+  hungarian_column_min_scalar(cost,m,n,col_min);
+}
+
+static int hungarian_explore_row(const int* cost_row, int s, int k, int n,
+    const int* col_inc, int* slack, int* slack_row, int* zeros) {
+#if HUNGARIAN_AVX2
+  if (hungarian_has_avx2())
+    return hungarian_explore_row_avx2(cost_row,s,k,n,col_inc,slack,slack_row,zeros);
+#endif
+  return hungarian_explore_row_scalar(cost_row,s,k,n,col_inc,slack,slack_row,zeros);
+}
+
+static int hungarian_slack_min(const int* slack, int n) {
+#if HUNGARIAN_AVX2
+  if (hungarian_has_avx2())
+    return hungarian_slack_min_avx2(slack,n);
+#endif
+  return hungarian_slack_min_scalar(slack,n);
+}
+
+typedef struct {
+  double** cost_matrix;
+  int cols;
+} hungarian_dense_t;
+
+static void hungarian_dense_row(void* ctx, int row, double* out) {
+  hungarian_dense_t* dense = (hungarian_dense_t*)ctx;
+  int j;
+  for (j=0; j<dense->cols; j++)
+    out[j]=dense->cost_matrix[row][j];
+}
+
 int hungarian_init(hungarian_problem_t* p, double** cost_matrix, int rows, int cols, int mode) {
+  hungarian_dense_t dense;
+  dense.cost_matrix = cost_matrix;
+  dense.cols = cols;
+  return hungarian_init_rows(p, hungarian_dense_row, &dense, rows, cols, mode);
+}
 
-  int i,j, org_cols, org_rows;
-  int max_cost;
-  max_cost = 0;
+// scratch memory of the calling thread, grown on demand and kept
+// between calls so that solving a node allocates nothing; freed when
+// the thread exits
+static thread_local std::vector<double> hungarian_row_buffer;
+static thread_local std::vector<int> hungarian_workspace;
+
+static double* hungarian_row_scratch(int cols) {
+  if (cols < 1)
+    cols = 1;
+  if (hungarian_row_buffer.size() < (size_t)cols)
+    hungarian_row_buffer.resize(cols);
+  return hungarian_row_buffer.data();
+}
 
-  org_cols = cols;
-  org_rows = rows;
+static int* hungarian_solve_scratch(size_t ints) {
+  if (hungarian_workspace.size() < ints)
+    hungarian_workspace.resize(ints);
+  return hungarian_workspace.data();
+}
 
-  // is the number of cols  not equal to number of rows ?
-  // if yes, expand with 0-cols / 0-cols
-  rows = hungarian_imax(cols, rows);
-  cols = rows;
+static void hungarian_alloc(hungarian_problem_t* p, int rows, int cols) {
+  int i;
 
   p->num_rows = rows;
   p->num_cols = cols;
 
+  // both matrices are single row-major blocks so that the solver
+  // loops walk contiguous memory
   p->cost = (int**)calloc(rows,sizeof(int*));
   hungarian_test_alloc(p->cost);
   p->assignment = (int**)calloc(rows,sizeof(int*));
   hungarian_test_alloc(p->assignment);
+  p->cost[0] = (int*)calloc((size_t)rows*cols,sizeof(int));
+  hungarian_test_alloc(p->cost[0]);
+  p->assignment[0] = (int*)calloc((size_t)rows*cols,sizeof(int));
+  hungarian_test_alloc(p->assignment[0]);
+
+  for(i=0; i<rows; i++) {
+    p->cost[i] = p->cost[0] + (size_t)i*cols;
+    p->assignment[i] = p->assignment[0] + (size_t)i*cols;
+  }
+}
+
+static void hungarian_fill_rows(hungarian_problem_t* p, hungarian_row_fn fill_row, void* ctx, int org_rows, int org_cols, int mode) {
+
+  int i,j;
+  int max_cost;
+  double* row;
+  max_cost = 0;
+
+  row = hungarian_row_scratch(org_cols);
 
   for(i=0; i<p->num_rows; i++) {
-    p->cost[i] = (int*)calloc(cols,sizeof(int));
-    hungarian_test_alloc(p->cost[i]);
-    p->assignment[i] = (int*)calloc(cols,sizeof(int));
-    hungarian_test_alloc(p->assignment[i]);
+    if (i < org_rows)
+      fill_row(ctx, i, row);
     for(j=0; j<p->num_cols; j++) {
-      p->cost[i][j] =  (i < org_rows && j < org_cols) ? cost_matrix[i][j] : 0;
+      p->cost[i][j] =  (i < org_rows && j < org_cols) ? row[j] : 0;
       p->assignment[i][j] = 0;
 
       if (max_cost < p->cost[i][j])
@@ -118,19 +351,64 @@ int hungarian_init(hungarian_problem_t* p, double** cost_matrix, int rows, int c
   }
   else
     fprintf(stderr,"%s: unknown mode. Mode was set to HUNGARIAN_MODE_MINIMIZE_COST !\n", __FUNCTION__);
+}
 
-  return rows;
+int hungarian_init_rows(hungarian_problem_t* p, hungarian_row_fn fill_row, void* ctx, int rows, int cols, int mode) {
+
+  int size;
+
+  // is the number of cols  not equal to number of rows ?
+  // if yes, expand with 0-cols / 0-cols
+  size = hungarian_imax(cols, rows);
+
+  hungarian_alloc(p, size, size);
+  hungarian_fill_rows(p, fill_row, ctx, rows, cols, mode);
+
+  return size;
 }
 
+int hungarian_reset_rows(hungarian_problem_t* p, hungarian_row_fn fill_row, void* ctx, int rows, int cols, int mode) {
 
+  int size;
 
+  size = hungarian_imax(cols, rows);
 
-void hungarian_free(hungarian_problem_t* p) {
-  int i;
-  for(i=0; i<p->num_rows; i++) {
-    free(p->cost[i]);
-    free(p->assignment[i]);
+  if (p->cost == NULL || p->num_rows != size || p->num_cols != size) {
+    if (p->cost != NULL)
+      hungarian_free(p);
+    hungarian_alloc(p, size, size);
   }
+  hungarian_fill_rows(p, fill_row, ctx, rows, cols, mode);
+
+  return size;
+}
+
+int hungarian_resize(hungarian_problem_t* p, int size) {
+
+  if (p->cost == NULL || p->num_rows != size || p->num_cols != size) {
+    if (p->cost != NULL)
+      hungarian_free(p);
+    hungarian_alloc(p, size, size);
+  }
+
+  return size;
+}
+
+int hungarian_reset_costs(hungarian_problem_t* p, const int* costs, int size) {
+
+  hungarian_resize(p, size);
+
+  // the assignment is cleared by the solve
+  memcpy(p->cost[0], costs, (size_t)size*size*sizeof(int));
+
+  return size;
+}
+
+
+
+void hungarian_free(hungarian_problem_t* p) {
+  free(p->cost[0]);
+  free(p->assignment[0]);
   free(p->cost);
   free(p->assignment);
   p->cost = NULL;
@@ -140,8 +418,16 @@ void hungarian_free(hungarian_problem_t* p) {
 
 
 int hungarian_solve(hungarian_problem_t* p)
+{
+  return hungarian_solve_cutoff(p, HUNGARIAN_NO_CUTOFF, NULL);
+}
+
+int hungarian_solve_cutoff(hungarian_problem_t* p, int cutoff, int* aborted)
 {
   int i, j, m, n, k, l, s, t, q, unmatched, cost;
+  // dual objective: col_min, row_dec and col_inc sums, kept up to
+  // date so the solve can stop once it is above the cutoff
+  long long dual;
   int* col_mate;
   int* row_mate;
   int* parent_row;
@@ -150,28 +436,24 @@ int hungarian_solve(hungarian_problem_t* p)
   int* col_inc;
   int* slack;
   int* slack_row;
+  int* col_min;
+  int* zeros;
 
   cost=0;
   m =p->num_rows;
   n =p->num_cols;
 
-  col_mate = (int*)calloc(p->num_rows,sizeof(int));
-  hungarian_test_alloc(col_mate);
-  unchosen_row = (int*)calloc(p->num_rows,sizeof(int));
-  hungarian_test_alloc(unchosen_row);
-  row_dec  = (int*)calloc(p->num_rows,sizeof(int));
-  hungarian_test_alloc(row_dec);
-  slack_row  = (int*)calloc(p->num_rows,sizeof(int));
-  hungarian_test_alloc(slack_row);
-
-  row_mate = (int*)calloc(p->num_cols,sizeof(int));
-  hungarian_test_alloc(row_mate);
-  parent_row = (int*)calloc(p->num_cols,sizeof(int));
-  hungarian_test_alloc(parent_row);
-  col_inc = (int*)calloc(p->num_cols,sizeof(int));
-  hungarian_test_alloc(col_inc);
-  slack = (int*)calloc(p->num_cols,sizeof(int));
-  hungarian_test_alloc(slack);
+  col_mate = hungarian_solve_scratch(4*(size_t)m + 6*(size_t)n);
+  unchosen_row = col_mate + m;
+  row_dec = unchosen_row + m;
+  slack_row = row_dec + m;
+
+  row_mate = slack_row + m;
+  parent_row = row_mate + n;
+  col_inc = parent_row + n;
+  slack = col_inc + n;
+  col_min = slack + n;
+  zeros = col_min + n;
 
   for (i=0;i<p->num_rows;i++) {
     col_mate[i]=0;
@@ -193,16 +475,14 @@ int hungarian_solve(hungarian_problem_t* p)
   // Begin subtract column minima in order to start with lots of zeroes 12
   if (verbose)
     fprintf(stderr, "Using heuristic\n");
+  hungarian_column_min(p->cost,m,n,col_min);
   for (l=0;l<n;l++)
-    {
-      s=p->cost[0][l];
-      for (k=1;k<m;k++)
-  if (p->cost[k][l]<s)
-    s=p->cost[k][l];
-      cost+=s;
-      if (s!=0)
+    cost+=col_min[l];
   for (k=0;k<m;k++)
-    p->cost[k][l]-=s;
+    {
+      int* row=p->cost[k];
+      for (l=0;l<n;l++)
+  row[l]-=col_min[l];
     }
   // End subtract column minima in order to start with lots of zeroes 12
 
@@ -240,9 +520,17 @@ int hungarian_solve(hungarian_problem_t* p)
     }
   // End initial state 16
 
+  dual=cost;
+  for (k=0;k<m;k++)
+    dual+=row_dec[k];
+  if (aborted)
+    *aborted=0;
+
   // Begin Hungarian algorithm 18
   if (t==0)
     goto done;
+  if (cutoff!=HUNGARIAN_NO_CUTOFF && dual>cutoff)
+    goto cut_off;
   unmatched=t;
   while (1)
     {
@@ -255,45 +543,34 @@ int hungarian_solve(hungarian_problem_t* p)
       {
         // Begin explore node q of the forest 19
         {
+    int z, zero_count;
     k=unchosen_row[q];
     s=row_dec[k];
-    for (l=0;l<n;l++)
-      if (slack[l])
-        {
-          int del;
-          del=p->cost[k][l]-s+col_inc[l];
-          if (del<slack[l])
+    // slack updates are done by the kernel, the new zeros it
+    // finds are looked at here in column order
+    zero_count=hungarian_explore_row(p->cost[k],s,k,n,col_inc,slack,slack_row,zeros);
+    for (z=0;z<zero_count;z++)
       {
-        if (del==0)
-          {
-            if (row_mate[l]<0)
-        goto breakthru;
-            slack[l]=0;
-            parent_row[l]=k;
-            if (verbose)
-        fprintf(stderr, "node %d: row %d==col %d--row %d\n",
-               t,row_mate[l],l,k);
-            unchosen_row[t++]=row_mate[l];
-          }
-        else
-          {
-            slack[l]=del;
-            slack_row[l]=k;
-          }
+        l=zeros[z];
+        if (row_mate[l]<0)
+    goto breakthru;
+        slack[l]=0;
+        parent_row[l]=k;
+        if (verbose)
+    fprintf(stderr, "node %d: row %d==col %d--row %d\n",
+           t,row_mate[l],l,k);
+        unchosen_row[t++]=row_mate[l];
       }
-        }
         }
         // End explore node q of the forest 19
         q++;
       }
 
     // Begin introduce a new zero into the matrix 21
-    s=INF;
-    for (l=0;l<n;l++)
-      if (slack[l] && slack[l]<s)
-        s=slack[l];
+    s=hungarian_slack_min(slack,n);
     for (q=0;q<t;q++)
       row_dec[unchosen_row[q]]+=s;
+    dual+=(long long)s*t;
     for (l=0;l<n;l++)
       if (slack[l])
         {
@@ -310,7 +587,10 @@ int hungarian_solve(hungarian_problem_t* p)
           {
       for (j=l+1;j<n;j++)
         if (slack[j]==0)
-          col_inc[j]+=s;
+          {
+      col_inc[j]+=s;
+      dual-=s;
+          }
       goto breakthru;
           }
         else
@@ -324,10 +604,17 @@ int hungarian_solve(hungarian_problem_t* p)
       }
         }
       else
-        col_inc[l]+=s;
+        {
+    col_inc[l]+=s;
+    dual-=s;
+        }
     // End introduce a new zero into the matrix 21
+    if (cutoff!=HUNGARIAN_NO_CUTOFF && dual>cutoff)
+      goto cut_off;
   }
     breakthru:
+      if (cutoff!=HUNGARIAN_NO_CUTOFF && dual>cutoff)
+        goto cut_off;
       // Begin update the matching 20
       if (verbose)
   fprintf(stderr, "Breakthrough at node %d of %d!\n",q,t);
@@ -391,10 +678,12 @@ int hungarian_solve(hungarian_problem_t* p)
     }
   for (k=0;k<m;++k)
     {
+      int* row=p->cost[k];
+      int dec=row_dec[k];
       for (l=0;l<n;++l)
   {
     /*TRACE("%d ",p->cost[k][l]-row_dec[k]+col_inc[l]);*/
-    p->cost[k][l]=p->cost[k][l]-row_dec[k]+col_inc[l];
+    row[l]=row[l]-dec+col_inc[l];
   }
       /*TRACE("\n");*/
     }
@@ -406,13 +695,14 @@ int hungarian_solve(hungarian_problem_t* p)
     fprintf(stderr, "Cost is %d\n",cost);
 
 
-  free(slack);
-  free(col_inc);
-  free(parent_row);
-  free(row_mate);
-  free(slack_row);
-  free(row_dec);
-  free(unchosen_row);
-  free(col_mate);
   return cost;
+
+ cut_off:
+  // the dual solution is feasible, so its objective bounds the
+  // cost of every assignment
+  if (verbose)
+    fprintf(stderr, "Dual bound %lld above cutoff %d\n",dual,cutoff);
+  if (aborted)
+    *aborted=1;
+  return dual<HUNGARIAN_NO_CUTOFF ? (int)dual : HUNGARIAN_NO_CUTOFF;
 }
@@ -33,6 +33,8 @@ extern "C" {
 #define HUNGARIAN_NOT_ASSIGNED 0
 #define HUNGARIAN_ASSIGNED 1
 
+#define HUNGARIAN_NO_CUTOFF 0x7FFFFFFF
+
 #define HUNGARIAN_MODE_MINIMIZE_COST   0
 #define HUNGARIAN_MODE_MAXIMIZE_UTIL 1
 
@@ -52,12 +54,54 @@ int hungarian_init(hungarian_problem_t* p,
        int cols,
        int mode);
 
+/** Writes row `row` of a cost matrix into `out`. **/
+typedef void (*hungarian_row_fn)(void* ctx, int row, double* out);
+
+/** Same as hungarian_init, with the cost matrix read row by row
+ *  through `fill_row` instead of from a dense array. **/
+int hungarian_init_rows(hungarian_problem_t* p,
+       hungarian_row_fn fill_row,
+       void* ctx,
+       int rows,
+       int cols,
+       int mode);
+
+/** Same as hungarian_init_rows on a problem that is already
+ *  initialized (or zeroed), its memory is reused when the size
+ *  is unchanged. **/
+int hungarian_reset_rows(hungarian_problem_t* p,
+       hungarian_row_fn fill_row,
+       void* ctx,
+       int rows,
+       int cols,
+       int mode);
+
+/** Same as hungarian_reset_rows in HUNGARIAN_MODE_MINIMIZE_COST,
+ *  with the costs copied from `costs`, a `size` x `size` row-major
+ *  matrix, in a single block. **/
+int hungarian_reset_costs(hungarian_problem_t* p,
+       const int* costs,
+       int size);
+
+/** Makes `p` a `size` x `size` problem whose costs the caller
+ *  writes to p->cost, its memory is reused when the size is
+ *  unchanged. **/
+int hungarian_resize(hungarian_problem_t* p,
+       int size);
+
 /** Free the memory allocated by init. **/
 void hungarian_free(hungarian_problem_t* p);
 
 /** This method computes the optimal assignment. **/
 int hungarian_solve(hungarian_problem_t* p);
 
+/** Same as hungarian_solve, but gives up as soon as the dual
+ *  bound of the assignment (which only grows while solving)
+ *  exceeds `cutoff` (HUNGARIAN_NO_CUTOFF for none): `*aborted` is
+ *  then set and that bound is returned, the assignment and reduced
+ *  costs being left unfinished. `aborted` may be NULL. **/
+int hungarian_solve_cutoff(hungarian_problem_t* p, int cutoff, int* aborted);
+
 /** Print the computed optimal assignment. **/
 void hungarian_print_assignment(hungarian_problem_t* p);
 
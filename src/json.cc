@@ -0,0 +1,361 @@
+#include <cstdlib> // strtod()
+#include <cstring> // strncmp()
+#include <cstdio> // snprintf()
+#include <cmath> // isfinite
+#include "json.h"
+
+// nesting allowed before a document is rejected, so that the
+// recursive parser can't exhaust the stack
+#define JSON_MAX_DEPTH 64
+
+typedef struct s_json_parser {
+	const char *text;
+	size_t pos;
+	size_t size;
+	std::string error;
+} JsonParser;
+
+static bool json_fail (JsonParser &parser, const char *message) {
+	if (parser.error.empty())
+		parser.error = std::string(message) + " at offset " + std::to_string(parser.pos);
+
+	return false;
+}
+
+static void json_skip_space (JsonParser &parser) {
+	while (parser.pos < parser.size) {
+		char c = parser.text[parser.pos];
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+			break;
+		++parser.pos;
+	}
+}
+
+static bool json_literal (JsonParser &parser, const char *word) {
+	size_t length = strlen(word);
+
+	if (parser.size - parser.pos < length || strncmp(parser.text + parser.pos, word, length) != 0)
+		return json_fail(parser, "invalid literal");
+
+	parser.pos += length;
+	return true;
+}
+
+static void json_append_utf8 (std::string &out, unsigned code) {
+	if (code < 0x80) {
+		out += (char) code;
+	} else if (code < 0x800) {
+		out += (char) (0xC0 | (code >> 6));
+		out += (char) (0x80 | (code & 0x3F));
+	} else if (code < 0x10000) {
+		out += (char) (0xE0 | (code >> 12));
+		out += (char) (0x80 | ((code >> 6) & 0x3F));
+		out += (char) (0x80 | (code & 0x3F));
+	} else {
+		out += (char) (0xF0 | (code >> 18));
+		out += (char) (0x80 | ((code >> 12) & 0x3F));
+		out += (char) (0x80 | ((code >> 6) & 0x3F));
+		out += (char) (0x80 | (code & 0x3F));
+	}
+}
+
+static bool json_hex4 (JsonParser &parser, unsigned &code) {
+	if (parser.size - parser.pos < 4)
+		return json_fail(parser, "truncated escape");
+
+	code = 0;
+	for (int i = 0; i < 4; ++i) {
+		char c = parser.text[parser.pos++];
+		code <<= 4;
+
+		if (c >= '0' && c <= '9')
+			code |= c - '0';
+		else if (c >= 'a' && c <= 'f')
+			code |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			code |= c - 'A' + 10;
+		else
+			return json_fail(parser, "invalid escape");
+	}
+
+	return true;
+}
+
+static bool json_parse_string (JsonParser &parser, std::string &out) {
+	// opening quote
+	++parser.pos;
+	out.clear();
+
+	while (parser.pos < parser.size) {
+		char c = parser.text[parser.pos++];
+
+		if (c == '"')
+			return true;
+
+		if ((unsigned char) c < 0x20)
+			return json_fail(parser, "control character in string");
+
+		if (c != '\\') {
+			out += c;
+			continue;
+		}
+
+		if (parser.pos >= parser.size)
+			break;
+
+		c = parser.text[parser.pos++];
+		switch (c) {
+		case '"': out += '"'; break;
+		case '\\': out += '\\'; break;
+		case '/': out += '/'; break;
+		case 'b': out += '\b'; break;
+		case 'f': out += '\f'; break;
+		case 'n': out += '\n'; break;
+		case 'r': out += '\r'; break;
+		case 't': out += '\t'; break;
+		case 'u': {
+			unsigned code;
+			if (!json_hex4(parser, code))
+				return false;
+
+			// surrogate pair
+			if (code >= 0xD800 && code < 0xDC00 && parser.size - parser.pos >= 6
+					&& parser.text[parser.pos] == '\\' && parser.text[parser.pos +1] == 'u') {
+				unsigned low;
+				parser.pos += 2;
+				if (!json_hex4(parser, low))
+					return false;
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+			}
+
+			json_append_utf8(out, code);
+			break;
+		}
+		default:
+			return json_fail(parser, "invalid escape");
+		}
+	}
+
+	return json_fail(parser, "unterminated string");
+}
+
+static bool json_parse_value (JsonParser &parser, JsonValue &value, int depth) {
+	json_skip_space(parser);
+
+	if (parser.pos >= parser.size)
+		return json_fail(parser, "unexpected end");
+
+	if (depth > JSON_MAX_DEPTH)
+		return json_fail(parser, "nested too deep");
+
+	value.type = JSON_NULL;
+	char c = parser.text[parser.pos];
+
+	if (c == '{') {
+		value.type = JSON_OBJECT;
+		++parser.pos;
+		json_skip_space(parser);
+
+		if (parser.pos < parser.size && parser.text[parser.pos] == '}') {
+			++parser.pos;
+			return true;
+		}
+
+		while (true) {
+			json_skip_space(parser);
+			if (parser.pos >= parser.size || parser.text[parser.pos] != '"')
+				return json_fail(parser, "expected member name");
+
+			value.members.push_back(std::pair<std::string, JsonValue> ());
+			std::pair<std::string, JsonValue> &member = value.members.back();
+
+			if (!json_parse_string(parser, member.first))
+				return false;
+
+			json_skip_space(parser);
+			if (parser.pos >= parser.size || parser.text[parser.pos] != ':')
+				return json_fail(parser, "expected ':'");
+			++parser.pos;
+
+			if (!json_parse_value(parser, member.second, depth +1))
+				return false;
+
+			json_skip_space(parser);
+			if (parser.pos < parser.size && parser.text[parser.pos] == ',') {
+				++parser.pos;
+				continue;
+			}
+			if (parser.pos < parser.size && parser.text[parser.pos] == '}') {
+				++parser.pos;
+				return true;
+			}
+
+			return json_fail(parser, "expected ',' or '}'");
+		}
+	}
+
+	if (c == '[') {
+		value.type = JSON_ARRAY;
+		++parser.pos;
+		json_skip_space(parser);
+
+		if (parser.pos < parser.size && parser.text[parser.pos] == ']') {
+			++parser.pos;
+			return true;
+		}
+
+		while (true) {
+			value.items.push_back(JsonValue());
+
+			if (!json_parse_value(parser, value.items.back(), depth +1))
+				return false;
+
+			json_skip_space(parser);
+			if (parser.pos < parser.size && parser.text[parser.pos] == ',') {
+				++parser.pos;
+				continue;
+			}
+			if (parser.pos < parser.size && parser.text[parser.pos] == ']') {
+				++parser.pos;
+				return true;
+			}
+
+			return json_fail(parser, "expected ',' or ']'");
+		}
+	}
+
+	if (c == '"') {
+		value.type = JSON_STRING;
+		return json_parse_string(parser, value.string);
+	}
+
+	if (c == 't' || c == 'f') {
+		value.type = JSON_BOOL;
+		value.boolean = c == 't';
+		return json_literal(parser, value.boolean ? "true" : "false");
+	}
+
+	if (c == 'n')
+		return json_literal(parser, "null");
+
+	// numbers, strtod accepts a superset of the JSON syntax
+	std::string number;
+	while (parser.pos < parser.size && strchr("+-0123456789.eE", parser.text[parser.pos])) {
+		number += parser.text[parser.pos++];
+	}
+
+	char *end;
+	value.type = JSON_NUMBER;
+	value.number = strtod(number.c_str(), &end);
+
+	if (number.empty() || *end != '\0')
+		return json_fail(parser, "invalid value");
+
+	return true;
+}
+
+bool json_parse (const std::string &text, JsonValue &value, std::string &error) {
+	JsonParser parser;
+	parser.text = text.c_str();
+	parser.pos = 0;
+	parser.size = text.size();
+
+	value = JsonValue();
+	bool ok = json_parse_value(parser, value, 0);
+
+	if (ok) {
+		json_skip_space(parser);
+		if (parser.pos != parser.size)
+			ok = json_fail(parser, "trailing characters");
+	}
+
+	error = parser.error;
+	return ok;
+}
+
+const JsonValue *json_member (const JsonValue &object, const char *name) {
+	if (object.type != JSON_OBJECT)
+		return NULL;
+
+	for (size_t i = 0; i < object.members.size(); ++i) {
+		if (object.members[i].first == name)
+			return &object.members[i].second;
+	}
+
+	return NULL;
+}
+
+void json_write_string (std::ostream &out, const std::string &text) {
+	out << '"';
+
+	for (size_t i = 0; i < text.size(); ++i) {
+		unsigned char c = text[i];
+
+		switch (c) {
+		case '"': out << "\\\""; break;
+		case '\\': out << "\\\\"; break;
+		case '\n': out << "\\n"; break;
+		case '\r': out << "\\r"; break;
+		case '\t': out << "\\t"; break;
+		default:
+			if (c < 0x20) {
+				char escape[8];
+				snprintf(escape, sizeof(escape), "\\u%04x", c);
+				out << escape;
+			} else {
+				out << c;
+			}
+		}
+	}
+
+	out << '"';
+}
+
+void json_write_number (std::ostream &out, double number) {
+	// JSON has no infinity nor NaN
+	if (!std::isfinite(number)) {
+		out << "null";
+		return;
+	}
+
+	// exact round trip, without changing the stream's precision
+	std::streamsize precision = out.precision(17);
+	out << number;
+	out.precision(precision);
+}
+
+void json_write (std::ostream &out, const JsonValue &value) {
+	switch (value.type) {
+	case JSON_BOOL:
+		out << (value.boolean ? "true" : "false");
+		break;
+	case JSON_NUMBER:
+		json_write_number(out, value.number);
+		break;
+	case JSON_STRING:
+		json_write_string(out, value.string);
+		break;
+	case JSON_ARRAY:
+		out << '[';
+		for (size_t i = 0; i < value.items.size(); ++i) {
+			if (i)
+				out << ',';
+			json_write(out, value.items[i]);
+		}
+		out << ']';
+		break;
+	case JSON_OBJECT:
+		out << '{';
+		for (size_t i = 0; i < value.members.size(); ++i) {
+			if (i)
+				out << ',';
+			json_write_string(out, value.members[i].first);
+			out << ':';
+			json_write(out, value.members[i].second);
+		}
+		out << '}';
+		break;
+	default:
+		out << "null";
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string> // string
+#include <vector> // vector
+#include <utility> // pair
+#include <ostream> // ostream
+
+#define JSON_NULL 0
+#define JSON_BOOL 1
+#define JSON_NUMBER 2
+#define JSON_STRING 3
+#define JSON_ARRAY 4
+#define JSON_OBJECT 5
+
+typedef struct s_json_value JsonValue;
+
+/**
+ * Parsed JSON document, only the fields of `type` are meaningful
+ */
+struct s_json_value {
+	int type;
+
+	bool boolean;
+	double number;
+	std::string string;
+
+	std::vector<JsonValue> items;
+	std::vector< std::pair<std::string, JsonValue> > members;
+};
+
+/**
+ * Parses `text`, which must hold a single JSON value, returns false
+ * with a message in `error` when it is malformed
+ */
+bool json_parse (const std::string &text, JsonValue &value, std::string &error);
+
+/**
+ * Member `name` of an object, NULL when missing or when `object`
+ * isn't an object
+ */
+const JsonValue *json_member (const JsonValue &object, const char *name);
+
+/**
+ * Writes `value` back as compact JSON
+ */
+void json_write (std::ostream &out, const JsonValue &value);
+
+/**
+ * Writes `number` with all its digits, null when it isn't finite
+ */
+void json_write_number (std::ostream &out, double number);
+
+/**
+ * Writes `text` as a quoted JSON string
+ */
+void json_write_string (std::ostream &out, const std::string &text);
+
+#endif
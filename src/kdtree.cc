@@ -0,0 +1,249 @@
+#include <vector> // vector
+#include <algorithm> // nth_element, push_heap, pop_heap, sort_heap
+#include <thread> // thread
+#include <utility> // pair
+#include <limits> // infinity
+#include "kdtree.h"
+
+typedef std::pair<double, int> KdCandidate;
+
+/**
+ * State of one neighbour query: the closest `k` cities accepted
+ * so far, kept as a max-heap on the squared distance
+ */
+typedef struct s_kd_query {
+	double x, y;
+	int city;
+	int k;
+
+	/**
+	 * Quadrant the neighbours must be in, -1 for any
+	 */
+	int quadrant;
+
+	std::vector<KdCandidate> heap;
+} KdQuery;
+
+static void kdtree_build_range (KdTree &tree, int lo, int hi, int threaded_levels) {
+	if (hi - lo < 1)
+		return;
+
+	double min_x = std::numeric_limits<double>::infinity(), max_x = -min_x;
+	double min_y = min_x, max_y = -min_x;
+
+	for (int i = lo; i < hi; ++i) {
+		int city = tree.index[i];
+		min_x = std::min(min_x, tree.x[city]);
+		max_x = std::max(max_x, tree.x[city]);
+		min_y = std::min(min_y, tree.y[city]);
+		max_y = std::max(max_y, tree.y[city]);
+	}
+
+	int mid = lo + (hi - lo) / 2;
+	unsigned char axis = (max_y - min_y > max_x - min_x) ? 1 : 0;
+	const std::vector<double> &coord = axis ? tree.y : tree.x;
+
+	std::nth_element(tree.index.begin() + lo, tree.index.begin() + mid,
+		tree.index.begin() + hi, [&coord] (int a, int b) { return coord[a] < coord[b]; });
+	tree.axis[mid] = axis;
+
+	// both halves are disjoint ranges of `index`
+	if (threaded_levels > 0 && hi - lo > 4096) {
+		std::thread left (kdtree_build_range, std::ref(tree), lo, mid, threaded_levels -1);
+		kdtree_build_range(tree, mid +1, hi, threaded_levels -1);
+		left.join();
+	} else {
+		kdtree_build_range(tree, lo, mid, 0);
+		kdtree_build_range(tree, mid +1, hi, 0);
+	}
+}
+
+void kdtree_build (KdTree &tree, const double *x, const double *y, int dimension, int threads) {
+	tree.x.assign(x, x + dimension);
+	tree.y.assign(y, y + dimension);
+	tree.index.resize(dimension);
+	tree.axis.assign(dimension, 0);
+
+	tree.min_x = tree.min_y = std::numeric_limits<double>::infinity();
+	tree.max_x = tree.max_y = -std::numeric_limits<double>::infinity();
+
+	for (int i = 0; i < dimension; ++i) {
+		tree.index[i] = i;
+		tree.min_x = std::min(tree.min_x, x[i]);
+		tree.max_x = std::max(tree.max_x, x[i]);
+		tree.min_y = std::min(tree.min_y, y[i]);
+		tree.max_y = std::max(tree.max_y, y[i]);
+	}
+
+	// each threaded level doubles the threads at work
+	int threaded_levels = 0;
+	while ((2 << threaded_levels) <= threads) {
+		++threaded_levels;
+	}
+
+	kdtree_build_range(tree, 0, dimension, threaded_levels);
+}
+
+/**
+ * Whether the offset (dx, dy) from the query lies in `quadrant`,
+ * the quadrants split the plane around the query (which is in none)
+ */
+static bool kdtree_in_quadrant (int quadrant, double dx, double dy) {
+	switch (quadrant) {
+	case 0: return dx > 0 && dy >= 0;
+	case 1: return dx <= 0 && dy > 0;
+	case 2: return dx < 0 && dy <= 0;
+	case 3: return dx >= 0 && dy < 0;
+	}
+
+	return true;
+}
+
+/**
+ * Whether the box may hold a point of the quadrant of the query
+ */
+static bool kdtree_box_meets_quadrant (const KdQuery &query,
+		double min_x, double max_x, double min_y, double max_y) {
+	switch (query.quadrant) {
+	case 0: return max_x > query.x && max_y >= query.y;
+	case 1: return min_x <= query.x && max_y > query.y;
+	case 2: return min_x < query.x && min_y <= query.y;
+	case 3: return max_x >= query.x && min_y < query.y;
+	}
+
+	return true;
+}
+
+static double kdtree_box_distance (const KdQuery &query,
+		double min_x, double max_x, double min_y, double max_y) {
+	double dx = std::max(0.0, std::max(min_x - query.x, query.x - max_x));
+	double dy = std::max(0.0, std::max(min_y - query.y, query.y - max_y));
+
+	return dx * dx + dy * dy;
+}
+
+static void kdtree_search (const KdTree &tree, KdQuery &query, int lo, int hi,
+		double min_x, double max_x, double min_y, double max_y) {
+	if (hi - lo < 1)
+		return;
+
+	bool full = (int) query.heap.size() == query.k;
+	if (full && kdtree_box_distance(query, min_x, max_x, min_y, max_y) > query.heap.front().first)
+		return;
+
+	if (!kdtree_box_meets_quadrant(query, min_x, max_x, min_y, max_y))
+		return;
+
+	int mid = lo + (hi - lo) / 2;
+	int city = tree.index[mid];
+	double dx = tree.x[city] - query.x;
+	double dy = tree.y[city] - query.y;
+
+	if (city != query.city && kdtree_in_quadrant(query.quadrant, dx, dy)) {
+		KdCandidate candidate (dx * dx + dy * dy, city);
+
+		if (!full) {
+			query.heap.push_back(candidate);
+			std::push_heap(query.heap.begin(), query.heap.end());
+		} else if (candidate < query.heap.front()) {
+			std::pop_heap(query.heap.begin(), query.heap.end());
+			query.heap.back() = candidate;
+			std::push_heap(query.heap.begin(), query.heap.end());
+		}
+	}
+
+	// the half holding the query first, it is the likeliest to
+	// shrink the search radius
+	bool on_y = tree.axis[mid];
+	double split = on_y ? tree.y[city] : tree.x[city];
+	bool query_left = (on_y ? query.y : query.x) < split;
+
+	for (int side = 0; side < 2; ++side) {
+		bool left = (side == 0) == query_left;
+
+		if (left) {
+			kdtree_search(tree, query, lo, mid,
+				min_x, on_y ? max_x : split, min_y, on_y ? split : max_y);
+		} else {
+			kdtree_search(tree, query, mid +1, hi,
+				on_y ? min_x : split, max_x, on_y ? split : min_y, max_y);
+		}
+	}
+}
+
+/**
+ * Runs `query` and appends its neighbours, closest first
+ */
+static void kdtree_run (const KdTree &tree, KdQuery &query, std::vector<int> &neighbours) {
+	query.heap.clear();
+	query.heap.reserve(query.k);
+
+	if (query.k > 0)
+		kdtree_search(tree, query, 0, tree.index.size(),
+			tree.min_x, tree.max_x, tree.min_y, tree.max_y);
+
+	std::sort_heap(query.heap.begin(), query.heap.end());
+
+	for (size_t i = 0; i < query.heap.size(); ++i) {
+		neighbours.push_back(query.heap[i].second);
+	}
+}
+
+void kdtree_nearest (const KdTree &tree, int city, int k, std::vector<int> &neighbours) {
+	KdQuery query;
+	query.x = tree.x[city];
+	query.y = tree.y[city];
+	query.city = city;
+	query.k = k;
+	query.quadrant = -1;
+
+	neighbours.clear();
+	kdtree_run(tree, query, neighbours);
+}
+
+void kdtree_quadrant_neighbours (const KdTree &tree, int city, int k, std::vector<int> &neighbours) {
+	KdQuery query;
+	query.x = tree.x[city];
+	query.y = tree.y[city];
+	query.city = city;
+	query.k = k;
+
+	neighbours.clear();
+	for (query.quadrant = 0; query.quadrant < 4; ++query.quadrant) {
+		kdtree_run(tree, query, neighbours);
+	}
+}
+
+static void kdtree_neighbour_range (const KdTree *tree, int k, std::vector<int> *lists,
+		int first, int last) {
+	std::vector<int> neighbours;
+
+	for (int city = first; city < last; ++city) {
+		kdtree_nearest(*tree, city, k, neighbours);
+		std::copy(neighbours.begin(), neighbours.end(), lists->begin() + (size_t) city * k);
+	}
+}
+
+void kdtree_neighbour_lists (const KdTree &tree, int k, std::vector<int> &lists, int threads) {
+	int dimension = tree.index.size();
+	lists.assign((size_t) dimension * k, -1);
+
+	if (threads < 1)
+		threads = 1;
+
+	// cities are handed out in contiguous blocks, each thread
+	// writes its own part of `lists`
+	std::vector<std::thread> workers;
+	int block = (dimension + threads -1) / threads;
+
+	for (int first = block; first < dimension; first += block) {
+		workers.push_back(std::thread(kdtree_neighbour_range, &tree, k, &lists,
+			first, std::min(dimension, first + block)));
+	}
+
+	kdtree_neighbour_range(&tree, k, &lists, 0, std::min(dimension, block));
+
+	for (size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <vector> // vector
+
+/**
+ * Balanced 2-d tree over the coordinates of the cities, for
+ * neighbour queries in O(log n) instead of a scan of a matrix row
+ *
+ * The tree is implicit: `index` is a permutation of the cities in
+ * which every subtree is a contiguous range whose splitting city is
+ * in the middle, so no node is allocated. Each range is split on
+ * the axis along which its cities spread the most.
+ *
+ * Distances are Euclidean in the plane of the coordinates, which
+ * orders neighbours as the EUC_2D, CEIL_2D and ATT distances do, and
+ * approximately for GEO (whose coordinates are latitudes and
+ * longitudes).
+ */
+typedef struct s_kd_tree {
+	std::vector<double> x;
+	std::vector<double> y;
+
+	std::vector<int> index;
+
+	/**
+	 * Splitting axis of the range whose middle is at position i of
+	 * `index`: 0 for x, 1 for y
+	 */
+	std::vector<unsigned char> axis;
+
+	/**
+	 * Bounding box of all the cities
+	 */
+	double min_x, max_x, min_y, max_y;
+} KdTree;
+
+/**
+ * Builds the tree over `dimension` cities, the subtrees of the top
+ * levels are built on up to `threads` threads
+ */
+void kdtree_build (KdTree &tree, const double *x, const double *y, int dimension, int threads);
+
+/**
+ * The `k` cities closest to `city` (itself excluded), closest first
+ */
+void kdtree_nearest (const KdTree &tree, int city, int k, std::vector<int> &neighbours);
+
+/**
+ * Up to `k` closest cities in each of the four quadrants around
+ * `city`, quadrant by quadrant (x+ y+, x- y+, x- y-, x+ y-) and
+ * closest first within each: neighbours that surround the city even
+ * when the closest ones are all on one side
+ */
+void kdtree_quadrant_neighbours (const KdTree &tree, int city, int k, std::vector<int> &neighbours);
+
+/**
+ * The `k` nearest neighbours of every city, on up to `threads`
+ * threads: those of city i are at [i * k, (i + 1) * k) of `lists`
+ */
+void kdtree_neighbour_lists (const KdTree &tree, int k, std::vector<int> &lists, int threads);
+
+#endif
@@ -1,52 +1,97 @@
 #include <iostream>
 #include <cstdlib> // exit()
-#include <vector> // vector
-#include <list> // list
-#include <utility> // pair
 #include <chrono> // measuring time
-#include <queue> // priority_queue
 #include "tsp.h"
-#include "node.h"
 #include "data.h"
-#include "hungarian.h"
-
-#define BEST_BOUND_SEARCH 1
-#define BREADTH_FIRST_SEARCH 2
-#define DEPTH_FIRST_SEARCH 3
+#include "options.h"
+#include "checkpoint.h"
+#include "search.h"
+#include "node.h" // print_subtour
+#include "trace.h"
+#include "server.h"
+#include "cache.h"
+#include "metrics.h"
 
 #define TESTS_TO_RUN 1
 
-// Custom compare for priority_queue
-class Compare
-{
-	public:
-	    bool operator() (Node &a, Node &b) {
-		    return a.lower_bound > b.lower_bound;
-		}
-};
+int main (int argc, char **argv) {
+	Options options;
+	options_parse(options, argc, argv);
 
-void search_best (TSPInfo &tsp_info);
-void search_breadth (TSPInfo &tsp_info);
-void search_depth (TSPInfo &tsp_info);
+	if (options.metrics_port > 0 && !metrics_start(options.metrics_port))
+		exit(EXIT_FAILURE);
+
+	if (options.serve) {
+		if (!options.trace_path.empty())
+			trace_start(options.trace_path);
+
+		int status = server_run(options);
+		metrics_stop();
+
+		if (!trace_dump())
+			std::cerr << "Could not write trace " << options.trace_path << std::endl;
+
+		exit(status);
+	}
 
-int main (int argc, char **argv) {
 	TSPInfo tsp_info;
-	tsp_init(tsp_info, argc, argv);
+	tsp_init(tsp_info, options.args.size(), options.args.data(), options_helper_threads(options));
 	tsp_info.upper_bound = INFINITE;
+	tsp_info.bounding = options.bounding;
+	tsp_info.branching = options.branching;
+	tsp_info.lookahead = options.lookahead;
+	tsp_info.symmetric_branching = options.symmetric && tsp_info.cost_matrix->isSymmetric();
+	tsp_info.solve = metrics_new_solve();
+
+	Checkpoint checkpoint;
+	Checkpoint *resume = NULL;
+
+	if (options.resume) {
+		if (!checkpoint_read(options.checkpoint_path, checkpoint)) {
+			std::cout << "Could not read checkpoint " << options.checkpoint_path << std::endl;
+			exit(EXIT_FAILURE);
+		}
+
+		if (checkpoint.dimension != tsp_info.dimension) {
+			std::cout << "Checkpoint " << options.checkpoint_path
+				<< " was saved for another instance" << std::endl;
+			exit(EXIT_FAILURE);
+		}
+
+		// the search continues with the method it was saved with
+		options.search = checkpoint.search;
+		resume = &checkpoint;
+	}
 
-	int choice = 0;
-	while (choice < 1 || choice > 3) {
+	int choice = options.search;
+	while (choice < 1 || choice > 6) {
 		std::cout << "Branch and Bound method for TSP" << std::endl;
 
 		std::cout << "Choose a method of tree traversal:" << std::endl
 			<< "1: BestBound" << std::endl
 			<< "2: Breadth first" << std::endl
 			<< "3: Depth first" << std::endl
+			<< "4: Hybrid (best bound with depth first dives)" << std::endl
+			<< "5: Portfolio (several strategies at once)" << std::endl
+			<< "6: Auto (probe strategies, keep the best)" << std::endl
 			<< "> ";
 
 		std::cin >> choice;
 	}
 
+	// the cache records the search its results come from
+	options.search = choice;
+
+	// the members of a portfolio stop each other, none of them has
+	// a frontier to save that covers the whole search
+	if (choice == PORTFOLIO_SEARCH && !options.checkpoint_path.empty()) {
+		std::cout << "--checkpoint can't be used with the portfolio search" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	if (!options.trace_path.empty())
+		trace_start(options.trace_path);
+
 	double durations[TESTS_TO_RUN];
 	double costs[TESTS_TO_RUN];
 
@@ -56,16 +101,20 @@ int main (int argc, char **argv) {
 
 		auto start = std::chrono::high_resolution_clock::now();
 
-		switch (choice) {
-		case BEST_BOUND_SEARCH:
-			search_best(tsp_info);
-			break;
-		case BREADTH_FIRST_SEARCH:
-			search_breadth(tsp_info);
-			break;
-		case DEPTH_FIRST_SEARCH:
-			search_depth(tsp_info);
-			break;
+		// a resumed search already has its incumbent
+		CacheEntry cached;
+		bool use_cache = !options.cache_dir.empty() && !resume;
+
+		if (use_cache && cache_load(options, tsp_info, cached)) {
+			std::cout << "Result from cache " << options.cache_dir << std::endl;
+		} else {
+			if (use_cache && tsp_info.upper_bound < INFINITE)
+				std::cout << "Starting from cached incumbent " << tsp_info.upper_bound << std::endl;
+
+			search_run(choice, tsp_info, options, resume);
+
+			if (use_cache && !cache_store(options, tsp_info, cached))
+				std::cout << "Could not write cache " << options.cache_dir << std::endl;
 		}
 
 		auto end = std::chrono::high_resolution_clock::now();
@@ -87,158 +136,43 @@ int main (int argc, char **argv) {
 
 	std::cout << "duration: " << duration / 1000000 << " seconds" << std::endl;
 
+	// costs past a million need more than the default 6 digits
+	std::streamsize precision = std::cout.precision(17);
 	std::cout << "Cost: " << cost << std::endl;
 
-	tsp_free(tsp_info);
-
-	exit(EXIT_SUCCESS);
-}
-
-void search_best (TSPInfo &tsp_info) {
-	Node root;
-	node_calculate_solution(root, tsp_info);
-
-	priority_queue<Node, std::vector<Node>, Compare> tree;
-	tree.push(root);
-
-	Node best = root;
-
-	while (tree.size()) {
-		Node curr_node = tree.top();
-		tree.pop();
-
-		std::vector<int> &subtour = curr_node.subtours[curr_node.chosen_subtour];
-
-		// creates and pushes children to tree, sorted by lowest lower_bound
-		for (size_t i = 0; i < subtour.size() -1; ++i) {
-			Node child;
-			child.prohibited_edges = curr_node.prohibited_edges;
-
-			// edge between nodes i and i+1
-			std::pair<int, int> curr_edge (subtour[i], subtour[i +1]);
-
-			child.prohibited_edges.push_back(curr_edge);
-
-			node_calculate_solution(child, tsp_info);
-
-			if (child.lower_bound > tsp_info.upper_bound) {
-				// ignore node and all of its childs
-				break;
-			}
-
-			// possible solution
-			if (child.cut) {
-				// if this solution cost is lower than the current upper bound
-				// then we updated the upper bound and this solution is marked as best
-				if (child.lower_bound < tsp_info.upper_bound) {
-					best = child;
-					tsp_info.upper_bound = child.lower_bound;
-				}
-
-				break;
-			}
-
-			tree.push(child);
-		}
+	switch (tsp_info.status) {
+	case SEARCH_TIME_LIMIT:
+		std::cout << "Stopped: time limit" << std::endl;
+		break;
+	case SEARCH_NODE_LIMIT:
+		std::cout << "Stopped: node limit" << std::endl;
+		break;
+	case SEARCH_GAP_LIMIT:
+		std::cout << "Stopped: gap limit" << std::endl;
+		break;
+	case SEARCH_STOPPED:
+		std::cout << "Stopped: open nodes left" << std::endl;
+		break;
 	}
-}
-
-void search_breadth (TSPInfo &tsp_info) {
-	Node root;
-	node_calculate_solution(root, tsp_info);
-
-	std::list<Node> tree;
-	tree.push_back(root);
-
-	Node best = root;
-
-	while (tree.size()) {
-		Node curr_node = tree.front();
-		tree.pop_front();
-
-		std::vector<int> &subtour = curr_node.subtours[curr_node.chosen_subtour];
-
-		// creates and pushes children to tree
-		for (size_t i = 0; i < subtour.size() -1; ++i) {
-			Node child;
-			child.prohibited_edges = curr_node.prohibited_edges;
-
-			// edge between nodes i and i+1
-			std::pair<int, int> curr_edge (subtour[i], subtour[i +1]);
-
-			child.prohibited_edges.push_back(curr_edge);
-
-			node_calculate_solution(child, tsp_info);
-
-			if (child.lower_bound > tsp_info.upper_bound) {
-				// ignore node and all of its childs
-				break;
-			}
 
-			// possible solution
-			if (child.cut) {
-				// if this solution cost is lower than the current upper bound
-				// then we updated the upper bound and this solution is marked as best
-				if (child.lower_bound < tsp_info.upper_bound) {
-					best = child;
-					tsp_info.upper_bound = child.lower_bound;
-				}
+	std::cout << "Lower bound: " << tsp_info.lower_bound << std::endl;
+	std::cout.precision(precision);
 
-				break;
-			}
+	std::cout << "Gap: " << 100 * search_gap(tsp_info.upper_bound, tsp_info.lower_bound)
+		<< "%" << std::endl;
+	std::cout << "Nodes: " << tsp_info.stats.expanded << " expanded, "
+		<< tsp_info.stats.generated << " generated" << std::endl;
 
-			tree.push_back(child);
-		}
+	if (tsp_info.best_tour.size()) {
+		std::cout << "Tour: ";
+		print_subtour(tsp_info.best_tour);
 	}
-}
-
-void search_depth (TSPInfo &tsp_info) {
-	Node root;
-	node_calculate_solution(root, tsp_info);
-
-	std::list<Node> tree;
-	tree.push_back(root);
-
-	Node best = root;
-
-	while (tree.size()) {
-		Node curr_node = tree.front();
-		tree.pop_front();
-
-		std::vector<int> &subtour = curr_node.subtours[curr_node.chosen_subtour];
-
-		// creates and pushes children to tree in inverse order
-		// when we acess the tree with front() we will do
-		// a depth first search
-		for (size_t i = subtour.size() -1; i > 0; --i) {
-			Node child;
-			child.prohibited_edges = curr_node.prohibited_edges;
 
-			// edge between nodes i-1 and i
-			std::pair<int, int> curr_edge (subtour[i -1], subtour[i]);
+	if (!trace_dump())
+		std::cout << "Could not write trace " << options.trace_path << std::endl;
 
-			child.prohibited_edges.push_back(curr_edge);
-
-			node_calculate_solution(child, tsp_info);
-
-			if (child.lower_bound > tsp_info.upper_bound) {
-				// ignore node and all of its childs
-				break;
-			}
-
-			// possible solution
-			if (child.cut) {
-				// if this solution cost is lower than the current upper bound
-				// then we updated the upper bound and this solution is marked as best
-				if (child.lower_bound < tsp_info.upper_bound) {
-					best = child;
-					tsp_info.upper_bound = child.lower_bound;
-				}
-
-				break;
-			}
+	metrics_stop();
+	tsp_free(tsp_info);
 
-			tree.push_front(child);
-		}
-	}
+	exit(EXIT_SUCCESS);
 }
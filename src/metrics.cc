@@ -0,0 +1,417 @@
+#include <iostream>
+#include <sstream> // ostringstream
+#include <string> // string
+#include <vector> // vector
+#include <memory> // unique_ptr
+#include <map> // map
+#include <algorithm> // min, max
+#include <mutex> // mutex
+#include <thread> // thread, sleep_for
+#include <chrono> // steady_clock
+#include <limits> // infinity
+#include <cmath> // isinf, isnan
+#include <cstring> // strerror, strncmp
+#include <cerrno> // errno
+#include <unistd.h> // close
+#include <sys/socket.h> // socket, bind, listen, accept, shutdown
+#include <sys/time.h> // timeval
+#include <netinet/in.h> // sockaddr_in
+#include <arpa/inet.h> // htonl, htons
+#include "metrics.h"
+#include "data.h" // INFINITE
+
+// milliseconds a scrape waits for the searches to publish
+#define METRICS_REFRESH_MS 50
+
+// bytes of a request read at most, and seconds a client may take
+#define METRICS_REQUEST_MAX 4096
+#define METRICS_REQUEST_TIMEOUT 2
+
+bool metrics_enabled = false;
+std::atomic<unsigned> metrics_generation (0);
+
+static const double metrics_bucket_bounds[METRICS_BUCKETS -1] = {
+	1e-5, 3e-5, 1e-4, 3e-4, 1e-3, 3e-3, 1e-2, 3e-2, 1e-1
+};
+
+static const char *metrics_solver_names[METRICS_SOLVERS] = { "hungarian", "assignment" };
+
+static std::mutex metrics_threads_mutex;
+static std::vector< std::unique_ptr<MetricsThread> > metrics_threads;
+static std::vector<MetricsThread *> metrics_free_threads;
+
+static std::atomic<long> metrics_solves (0);
+
+static int metrics_listener = -1;
+static std::thread metrics_server;
+
+double metrics_now () {
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long metrics_new_solve () {
+	return ++metrics_solves;
+}
+
+/**
+ * Record of a thread, handed back to metrics_free_threads when the
+ * thread exits
+ */
+typedef struct s_metrics_owner {
+	MetricsThread *thread = NULL;
+
+	~s_metrics_owner () {
+		if (!thread)
+			return;
+
+		std::lock_guard<std::mutex> lock(metrics_threads_mutex);
+		thread->searching = false;
+		metrics_free_threads.push_back(thread);
+	}
+} MetricsOwner;
+
+MetricsThread &metrics_thread () {
+	thread_local MetricsOwner owner;
+
+	if (!owner.thread) {
+		std::lock_guard<std::mutex> lock(metrics_threads_mutex);
+
+		// the solve times of its previous threads are kept, the
+		// histograms only grow
+		if (metrics_free_threads.size()) {
+			owner.thread = metrics_free_threads.back();
+			metrics_free_threads.pop_back();
+			owner.thread->seen = metrics_generation;
+			return *owner.thread;
+		}
+
+		metrics_threads.emplace_back(new MetricsThread);
+		MetricsThread *thread = metrics_threads.back().get();
+		owner.thread = thread;
+		thread->id = metrics_threads.size();
+		thread->searching = false;
+		thread->started = 0;
+		thread->solve = 0;
+		thread->expanded = 0;
+		thread->generated = 0;
+		thread->open = 0;
+		thread->frontier_bytes = 0;
+		thread->lower_bound = -std::numeric_limits<double>::infinity();
+		thread->upper_bound = INFINITE;
+		thread->idle = 0;
+		thread->seen = metrics_generation;
+
+		for (int s = 0; s < METRICS_SOLVERS; ++s) {
+			for (int b = 0; b < METRICS_BUCKETS; ++b) {
+				thread->solves[s][b] = 0;
+			}
+			thread->solve_seconds[s] = 0;
+		}
+	}
+
+	return *owner.thread;
+}
+
+void metrics_search_begin (MetricsThread &thread, long solve) {
+	thread.started = metrics_now();
+	thread.solve = solve;
+	thread.expanded = 0;
+	thread.generated = 0;
+	thread.open = 0;
+	thread.frontier_bytes = 0;
+	thread.lower_bound = -std::numeric_limits<double>::infinity();
+	thread.upper_bound = INFINITE;
+	thread.idle = 0;
+	thread.searching = true;
+}
+
+void metrics_search_end (MetricsThread &thread) {
+	thread.searching = false;
+}
+
+void metrics_observe (int solver, double seconds) {
+	MetricsThread &thread = metrics_thread();
+	int bucket = 0;
+
+	while (bucket < METRICS_BUCKETS -1 && seconds > metrics_bucket_bounds[bucket]) {
+		++bucket;
+	}
+
+	// only this thread writes its record
+	thread.solves[solver][bucket].store(thread.solves[solver][bucket].load(std::memory_order_relaxed) + 1,
+		std::memory_order_relaxed);
+	thread.solve_seconds[solver].store(thread.solve_seconds[solver].load(std::memory_order_relaxed) + seconds,
+		std::memory_order_relaxed);
+}
+
+static void metrics_value (std::ostream &out, double value) {
+	if (std::isnan(value))
+		out << "NaN";
+	else if (std::isinf(value))
+		out << (value > 0 ? "+Inf" : "-Inf");
+	else
+		out << value;
+}
+
+static void metrics_header (std::ostream &out, const char *name, const char *type, const char *help) {
+	out << "# HELP " << name << " " << help << "\n"
+		<< "# TYPE " << name << " " << type << "\n";
+}
+
+/**
+ * Labels of the values of `thread`: the thread and its solve
+ */
+static void metrics_labels (std::ostream &out, const MetricsThread &thread) {
+	out << "{thread=\"" << thread.id << "\",solve=\"" << thread.solve << "\"}";
+}
+
+/**
+ * Metrics of every thread, once the searches had a moment to
+ * publish their values
+ */
+static std::string metrics_text () {
+	++metrics_generation;
+	std::this_thread::sleep_for(std::chrono::milliseconds(METRICS_REFRESH_MS));
+
+	std::lock_guard<std::mutex> lock(metrics_threads_mutex);
+	std::ostringstream out;
+	out.precision(10);
+
+	double now = metrics_now();
+	std::vector<MetricsThread *> searching;
+
+	for (size_t t = 0; t < metrics_threads.size(); ++t) {
+		if (metrics_threads[t]->searching)
+			searching.push_back(metrics_threads[t].get());
+	}
+
+	metrics_header(out, "bnb_searches_running", "gauge", "Threads running a search");
+	out << "bnb_searches_running " << searching.size() << "\n";
+
+	metrics_header(out, "bnb_nodes_expanded_total", "counter", "Nodes expanded by the search of the thread");
+	for (size_t t = 0; t < searching.size(); ++t) {
+		out << "bnb_nodes_expanded_total";
+		metrics_labels(out, *searching[t]);
+		out << " " << searching[t]->expanded << "\n";
+	}
+
+	metrics_header(out, "bnb_nodes_generated_total", "counter", "Nodes evaluated by the search of the thread");
+	for (size_t t = 0; t < searching.size(); ++t) {
+		out << "bnb_nodes_generated_total";
+		metrics_labels(out, *searching[t]);
+		out << " " << searching[t]->generated << "\n";
+	}
+
+	metrics_header(out, "bnb_nodes_per_second", "gauge", "Nodes expanded per second since the search started");
+	for (size_t t = 0; t < searching.size(); ++t) {
+		double elapsed = now - searching[t]->started;
+
+		out << "bnb_nodes_per_second";
+		metrics_labels(out, *searching[t]);
+		out << " ";
+		metrics_value(out, elapsed > 0 ? searching[t]->expanded / elapsed : 0);
+		out << "\n";
+	}
+
+	metrics_header(out, "bnb_thread_utilization", "gauge", "Share of the time the thread had work since the search started");
+	for (size_t t = 0; t < searching.size(); ++t) {
+		double elapsed = now - searching[t]->started;
+
+		out << "bnb_thread_utilization";
+		metrics_labels(out, *searching[t]);
+		out << " ";
+		metrics_value(out, elapsed > 0 ? 1 - searching[t]->idle / elapsed : 1);
+		out << "\n";
+	}
+
+	long open = 0;
+	double bytes = 0;
+
+	// bounds of each solve: every search of a solve bounds the whole
+	// instance, so the best one holds, and the incumbent is shared
+	std::map< long, std::pair<double, double> > solves;
+
+	for (size_t t = 0; t < searching.size(); ++t) {
+		open += searching[t]->open;
+		bytes += searching[t]->frontier_bytes;
+
+		long solve = searching[t]->solve;
+		if (!solves.count(solve))
+			solves[solve] = std::make_pair(-std::numeric_limits<double>::infinity(), (double) INFINITE);
+
+		std::pair<double, double> &bounds = solves[solve];
+		bounds.first = std::max(bounds.first, (double) searching[t]->lower_bound);
+		bounds.second = std::min(bounds.second, (double) searching[t]->upper_bound);
+	}
+
+	metrics_header(out, "bnb_open_nodes", "gauge", "Open nodes of the running searches");
+	out << "bnb_open_nodes " << open << "\n";
+
+	metrics_header(out, "bnb_frontier_bytes", "gauge", "Memory held by the open nodes");
+	out << "bnb_frontier_bytes ";
+	metrics_value(out, bytes);
+	out << "\n";
+
+	if (solves.size()) {
+		std::map< long, std::pair<double, double> >::iterator it;
+
+		metrics_header(out, "bnb_lower_bound", "gauge", "Best bound of the solve: lowest bound of the open nodes");
+		for (it = solves.begin(); it != solves.end(); ++it) {
+			// the bound of a search with no open node is its
+			// incumbent's
+			double lower_bound = std::min(it->second.first, it->second.second);
+
+			out << "bnb_lower_bound{solve=\"" << it->first << "\"} ";
+			metrics_value(out, lower_bound < INFINITE ? lower_bound : std::numeric_limits<double>::infinity());
+			out << "\n";
+		}
+
+		metrics_header(out, "bnb_incumbent", "gauge", "Cost of the best tour found by the solve");
+		for (it = solves.begin(); it != solves.end(); ++it) {
+			out << "bnb_incumbent{solve=\"" << it->first << "\"} ";
+			metrics_value(out, it->second.second < INFINITE ? it->second.second
+				: std::numeric_limits<double>::infinity());
+			out << "\n";
+		}
+
+		metrics_header(out, "bnb_gap", "gauge", "Relative gap between the incumbent and the best bound of the solve");
+		for (it = solves.begin(); it != solves.end(); ++it) {
+			double lower_bound = std::min(it->second.first, it->second.second);
+			double upper_bound = it->second.second;
+
+			out << "bnb_gap{solve=\"" << it->first << "\"} ";
+			metrics_value(out, upper_bound >= INFINITE ? std::numeric_limits<double>::infinity()
+				: upper_bound > 0 ? (upper_bound - lower_bound) / upper_bound : 0);
+			out << "\n";
+		}
+	}
+
+	metrics_header(out, "bnb_solve_seconds", "histogram", "Time of the assignment solves");
+	for (int s = 0; s < METRICS_SOLVERS; ++s) {
+		long count = 0;
+		double sum = 0;
+
+		for (int b = 0; b < METRICS_BUCKETS; ++b) {
+			for (size_t t = 0; t < metrics_threads.size(); ++t) {
+				count += metrics_threads[t]->solves[s][b];
+			}
+
+			out << "bnb_solve_seconds_bucket{solver=\"" << metrics_solver_names[s] << "\",le=\"";
+			metrics_value(out, b < METRICS_BUCKETS -1 ? metrics_bucket_bounds[b]
+				: std::numeric_limits<double>::infinity());
+			out << "\"} " << count << "\n";
+		}
+
+		for (size_t t = 0; t < metrics_threads.size(); ++t) {
+			sum += metrics_threads[t]->solve_seconds[s];
+		}
+
+		out << "bnb_solve_seconds_sum{solver=\"" << metrics_solver_names[s] << "\"} " << sum << "\n"
+			<< "bnb_solve_seconds_count{solver=\"" << metrics_solver_names[s] << "\"} " << count << "\n";
+	}
+
+	return out.str();
+}
+
+/**
+ * Answers one HTTP request: the metrics on GET /metrics, 404
+ * otherwise
+ */
+static void metrics_answer (int fd) {
+	timeval timeout = timeval();
+	timeout.tv_sec = METRICS_REQUEST_TIMEOUT;
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	std::string request;
+	char buffer[512];
+
+	while (request.size() < METRICS_REQUEST_MAX && request.find("\r\n\r\n") == std::string::npos) {
+		ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+		if (count <= 0)
+			break;
+
+		request.append(buffer, count);
+	}
+
+	std::string status = "200 OK";
+	std::string body;
+
+	if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 13, "GET /metrics?") == 0)
+		body = metrics_text();
+	else {
+		status = "404 Not Found";
+		body = "Not found, the metrics are at /metrics\n";
+	}
+
+	std::ostringstream response;
+	response << "HTTP/1.0 " << status << "\r\n"
+		<< "Content-Type: text/plain; version=0.0.4\r\n"
+		<< "Content-Length: " << body.size() << "\r\n"
+		<< "Connection: close\r\n\r\n"
+		<< body;
+
+	std::string text = response.str();
+	size_t sent = 0;
+
+	while (sent < text.size()) {
+		ssize_t count = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+		if (count <= 0)
+			break;
+
+		sent += count;
+	}
+}
+
+static void metrics_serve (int listener) {
+	while (true) {
+		int fd = accept(listener, NULL, NULL);
+
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			break;
+		}
+
+		metrics_answer(fd);
+		close(fd);
+	}
+}
+
+bool metrics_start (int port) {
+	sockaddr_in address = sockaddr_in();
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	int reuse = 1;
+
+	if (listener >= 0)
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	if (listener < 0 || bind(listener, (sockaddr *) &address, sizeof(address)) != 0
+			|| listen(listener, SOMAXCONN) != 0) {
+		std::cerr << "Could not serve metrics on port " << port << ": " << strerror(errno) << std::endl;
+		if (listener >= 0)
+			close(listener);
+		return false;
+	}
+
+	metrics_enabled = true;
+	metrics_listener = listener;
+	metrics_server = std::thread(metrics_serve, listener);
+
+	return true;
+}
+
+void metrics_stop () {
+	if (metrics_listener < 0)
+		return;
+
+	shutdown(metrics_listener, SHUT_RDWR);
+	metrics_server.join();
+
+	close(metrics_listener);
+	metrics_listener = -1;
+}
@@ -0,0 +1,147 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic> // atomic
+
+/**
+ * Optional live metrics of the running searches, served in the
+ * Prometheus text format on http://127.0.0.1:PORT/metrics
+ *
+ * Each thread that searches has its own record, which only it
+ * writes, and which the next thread takes over once it exits. A
+ * scrape asks the searches for fresh values and waits a moment for
+ * them: until then they only compare a counter once per node, and
+ * while metrics are off they don't even do that. The bounds are
+ * reported per solve, each solve grouping the threads that search
+ * the same instance at once (the threads of a parallel search, the
+ * members of a portfolio).
+ */
+
+// solvers whose times are kept in a histogram: the hungarian of
+// the node evaluations and the assignment solver of the depth first
+// search
+#define METRICS_HUNGARIAN 0
+#define METRICS_ASSIGNMENT 1
+#define METRICS_SOLVERS 2
+
+// upper bounds (seconds) of the buckets of the solve time histograms,
+// the last bucket is unbounded
+#define METRICS_BUCKETS 10
+
+/**
+ * Only written by metrics_start(), before the search starts
+ */
+extern bool metrics_enabled;
+
+typedef struct s_metrics_thread {
+	int id;
+
+	/**
+	 * Whether a search runs on the thread, and since when (seconds
+	 * of metrics_now())
+	 */
+	std::atomic<bool> searching;
+	std::atomic<double> started;
+
+	/**
+	 * Solve the search belongs to (see metrics_new_solve)
+	 */
+	std::atomic<long> solve;
+
+	/**
+	 * Values published by the search for the last scrape, minus
+	 * infinity for a lower bound it doesn't know (its open nodes are
+	 * counted by another thread of the solve)
+	 */
+	std::atomic<long> expanded;
+	std::atomic<long> generated;
+	std::atomic<long> open;
+	std::atomic<double> frontier_bytes;
+	std::atomic<double> lower_bound;
+	std::atomic<double> upper_bound;
+
+	/**
+	 * Seconds the search waited for work (threads of a parallel
+	 * search)
+	 */
+	std::atomic<double> idle;
+
+	/**
+	 * Solve times since the thread started: count per bucket, and
+	 * their sum
+	 */
+	std::atomic<long> solves[METRICS_SOLVERS][METRICS_BUCKETS];
+	std::atomic<double> solve_seconds[METRICS_SOLVERS];
+
+	/**
+	 * Last scrape the values were published for
+	 */
+	unsigned seen;
+} MetricsThread;
+
+extern std::atomic<unsigned> metrics_generation;
+
+double metrics_now ();
+
+/**
+ * Identifier of a new solve, for the searches of one request
+ */
+long metrics_new_solve ();
+
+/**
+ * Record of the calling thread, registered on its first use
+ */
+MetricsThread &metrics_thread ();
+
+/**
+ * Whether a scrape is waiting for the values of `thread`, which
+ * are then expected before the next call
+ */
+inline bool metrics_requested (MetricsThread &thread) {
+	unsigned generation = metrics_generation.load(std::memory_order_relaxed);
+
+	if (generation == thread.seen)
+		return false;
+
+	thread.seen = generation;
+	return true;
+}
+
+/**
+ * Marks the start, as part of `solve`, and the end of a search on
+ * the calling thread
+ */
+void metrics_search_begin (MetricsThread &thread, long solve);
+void metrics_search_end (MetricsThread &thread);
+
+void metrics_observe (int solver, double seconds);
+
+/**
+ * Serves the metrics on 127.0.0.1:`port` from a background thread,
+ * returns false when the port can't be listened on
+ */
+bool metrics_start (int port);
+void metrics_stop ();
+
+/**
+ * Times the enclosing solve for the histogram of `solver`
+ */
+class MetricsSolveScope
+{
+	public:
+		explicit MetricsSolveScope (int solver) : solver(solver), start(0) {
+			if (metrics_enabled)
+				start = metrics_now();
+		}
+
+		~MetricsSolveScope () {
+			if (metrics_enabled)
+				metrics_observe(solver, metrics_now() - start);
+		}
+
+	private:
+		int solver;
+		double start;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include <algorithm> // push_heap, pop_heap, make_heap, partition
+#include <limits> // infinity
+#include <utility> // move
+#include "multiqueue.h"
+
+// heaps tried at random before pop() looks through all of them
+#define MULTIQUEUE_ATTEMPTS 8
+
+static const double MULTIQUEUE_EMPTY = std::numeric_limits<double>::infinity();
+
+static bool multiqueue_compare (const Node &a, const Node &b) {
+	return a.lower_bound > b.lower_bound;
+}
+
+MultiQueue::MultiQueue (size_t queues) : shards(std::max(queues, (size_t) 1)) {
+	for (size_t i = 0; i < shards.size(); ++i) {
+		shards[i].top = MULTIQUEUE_EMPTY;
+	}
+}
+
+/**
+ * Random heap index (xorshift64)
+ */
+size_t MultiQueue::pick (uint64_t &seed) const {
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+
+	return seed % shards.size();
+}
+
+void MultiQueue::update_top (Shard &shard) {
+	shard.top.store(shard.heap.empty() ? MULTIQUEUE_EMPTY : shard.heap.front().lower_bound,
+		std::memory_order_relaxed);
+}
+
+void MultiQueue::push (Node &&node, uint64_t &seed) {
+	while (true) {
+		Shard &shard = shards[pick(seed)];
+
+		if (!shard.mutex.try_lock())
+			continue;
+
+		shard.heap.push_back(std::move(node));
+		std::push_heap(shard.heap.begin(), shard.heap.end(), multiqueue_compare);
+		update_top(shard);
+
+		shard.mutex.unlock();
+		return;
+	}
+}
+
+bool MultiQueue::pop (Node &node, uint64_t &seed) {
+	for (int attempt = 0; attempt < MULTIQUEUE_ATTEMPTS; ++attempt) {
+		Shard &a = shards[pick(seed)];
+		Shard &b = shards[pick(seed)];
+		Shard &shard = a.top.load(std::memory_order_relaxed) <= b.top.load(std::memory_order_relaxed) ? a : b;
+
+		if (shard.top.load(std::memory_order_relaxed) == MULTIQUEUE_EMPTY || !shard.mutex.try_lock())
+			continue;
+
+		bool found = !shard.heap.empty();
+		if (found) {
+			std::pop_heap(shard.heap.begin(), shard.heap.end(), multiqueue_compare);
+			node = std::move(shard.heap.back());
+			shard.heap.pop_back();
+			update_top(shard);
+		}
+
+		shard.mutex.unlock();
+		if (found)
+			return true;
+	}
+
+	// few nodes left: look for one in every heap
+	for (size_t i = 0; i < shards.size(); ++i) {
+		Shard &shard = shards[i];
+
+		if (shard.top.load(std::memory_order_relaxed) == MULTIQUEUE_EMPTY)
+			continue;
+
+		std::lock_guard<std::mutex> lock (shard.mutex);
+
+		if (!shard.heap.empty()) {
+			std::pop_heap(shard.heap.begin(), shard.heap.end(), multiqueue_compare);
+			node = std::move(shard.heap.back());
+			shard.heap.pop_back();
+			update_top(shard);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t MultiQueue::prune (double upper_bound) {
+	size_t removed = 0;
+
+	for (size_t i = 0; i < shards.size(); ++i) {
+		Shard &shard = shards[i];
+		std::lock_guard<std::mutex> lock (shard.mutex);
+
+		std::vector<Node>::iterator end = std::partition(shard.heap.begin(), shard.heap.end(),
+			[&] (const Node &node) { return node.lower_bound <= upper_bound; });
+
+		for (std::vector<Node>::iterator it = end; it != shard.heap.end(); ++it) {
+			node_recycle(*it);
+		}
+
+		removed += shard.heap.end() - end;
+		shard.heap.erase(end, shard.heap.end());
+		std::make_heap(shard.heap.begin(), shard.heap.end(), multiqueue_compare);
+		update_top(shard);
+	}
+
+	return removed;
+}
+
+double MultiQueue::lower_bound (double upper_bound) const {
+	double lower_bound = upper_bound;
+
+	for (size_t i = 0; i < shards.size(); ++i) {
+		lower_bound = std::min(lower_bound, shards[i].top.load(std::memory_order_relaxed));
+	}
+
+	return lower_bound;
+}
+
+size_t MultiQueue::memory () {
+	size_t bytes = 0;
+
+	for (size_t i = 0; i < shards.size(); ++i) {
+		Shard &shard = shards[i];
+		std::lock_guard<std::mutex> lock (shard.mutex);
+
+		for (size_t k = 0; k < shard.heap.size(); ++k) {
+			bytes += node_memory(shard.heap[k]);
+		}
+	}
+
+	return bytes;
+}
+
+void MultiQueue::drain (std::vector<Node> &nodes) {
+	for (size_t i = 0; i < shards.size(); ++i) {
+		Shard &shard = shards[i];
+
+		for (size_t k = 0; k < shard.heap.size(); ++k) {
+			nodes.push_back(std::move(shard.heap[k]));
+		}
+
+		shard.heap.clear();
+		update_top(shard);
+	}
+}
@@ -0,0 +1,76 @@
+#ifndef MULTIQUEUE_H
+#define MULTIQUEUE_H
+
+#include <vector> // vector
+#include <mutex> // mutex
+#include <atomic> // atomic
+#include <cstdint> // uint64_t
+#include "node.h"
+
+/**
+ * Relaxed priority queue of open nodes shared by the threads of a
+ * best-bound search (Rihani, Sanders and Dementiev's MultiQueue):
+ * a number of binary heaps, each with its own lock, a few per
+ * thread
+ *
+ * A node is pushed to a random heap, and popped from the better
+ * top of two random heaps, so threads seldom wait on each other and
+ * still get nodes whose bound is among the lowest (the expected
+ * rank of a popped node grows with the number of heaps, not with
+ * the size of the tree). The bound on top of each heap is kept
+ * where it can be read without taking the lock.
+ */
+class MultiQueue
+{
+	public:
+		explicit MultiQueue (size_t queues);
+
+		/**
+		 * `seed` is the state of the calling thread's random
+		 * numbers, any value but 0 to start
+		 */
+		void push (Node &&node, uint64_t &seed);
+
+		/**
+		 * Takes a node with one of the lowest bounds, returns
+		 * false when every heap looked empty
+		 */
+		bool pop (Node &node, uint64_t &seed);
+
+		/**
+		 * Removes the nodes whose bound is above `upper_bound`,
+		 * returns how many
+		 */
+		size_t prune (double upper_bound);
+
+		/**
+		 * Lowest bound of the open nodes, `upper_bound` when there
+		 * are none below it
+		 */
+		double lower_bound (double upper_bound) const;
+
+		/**
+		 * Bytes held by the nodes
+		 */
+		size_t memory ();
+
+		/**
+		 * Moves every node out to `nodes`, with no thread using
+		 * the queue
+		 */
+		void drain (std::vector<Node> &nodes);
+
+	private:
+		struct alignas(64) Shard {
+			std::mutex mutex;
+			std::vector<Node> heap;
+			std::atomic<double> top;
+		};
+
+		size_t pick (uint64_t &seed) const;
+		void update_top (Shard &shard);
+
+		std::vector<Shard> shards;
+};
+
+#endif
@@ -1,9 +1,14 @@
 #include <iostream>
 #include <vector> // vector
+#include <cmath> // floor
 #include "data.h" // INFINITE
 #include "tsp.h"
 #include "node.h"
 #include "hungarian.h"
+#include "bounding.h"
+#include "branching.h"
+#include "trace.h"
+#include "metrics.h"
 
 void print_subtour (std::vector<int> &subtour) {
 	int len = subtour.size();
@@ -44,50 +49,101 @@ void print_node (Node &node) {
 	std::cout << "== end node ==" << std::endl;
 }
 
+// nodes and subtour buffers kept by each thread's pool, what is
+// recycled beyond that is freed
+#define NODE_POOL_NODES 1024
+#define NODE_POOL_SUBTOURS 4096
+
 /**
- * Finds the smallest subtour of `root` and assigns it to
- * `root.chosen_subtour`
- *
- * In case of a tie, the subtour which the first node has
- * the lowest index gets chosen
+ * Memory of discarded nodes, one pool per thread so no locking
+ * is needed
  */
-void node_set_chosen_subtour (Node &root) {
-	int total_subtours = root.subtours.size();
+typedef struct s_node_pool {
+	std::vector<Node> nodes;
+	std::vector< std::vector<int> > subtours;
+
+	/**
+	 * Scratch of node_get_subtours and node_get_subtours_assignment
+	 */
+	std::vector<bool> visited;
+	std::vector<int> successor;
+
+	/**
+	 * Assignment problem of the node being evaluated, its matrices
+	 * are kept from one node to the next and freed with the thread
+	 */
+	hungarian_problem_t problem;
+
+	s_node_pool () : problem() {}
+
+	~s_node_pool () {
+		if (problem.cost)
+			hungarian_free(&problem);
+	}
+} NodePool;
 
-	int eligible_subtour = 0;
-	int lowest_size = root.subtours[eligible_subtour].size();
+static thread_local NodePool node_pool;
 
-	// searching for smallest subtour
-	for (int i = 1; i < total_subtours; ++i) {
-		int current_size = root.subtours[i].size();
+Node node_new () {
+	if (node_pool.nodes.empty())
+		return Node();
 
-		if (current_size > lowest_size) {
-			continue;
-		} else if (current_size == lowest_size) {
-			// if the current and eligible subtours have the same size
-			// the subtour with the lowest index for the first node becomes
-			// the eligible
-			if (root.subtours[i][0] < root.subtours[eligible_subtour][0])
-				eligible_subtour = i;
-		} else {
-			// the current subtour is the smallest
-			eligible_subtour = i;
-			lowest_size = current_size;
-		}
+	Node node = std::move(node_pool.nodes.back());
+	node_pool.nodes.pop_back();
+
+	return node;
+}
+
+void node_recycle (Node &node) {
+	for (size_t i = 0; i < node.subtours.size(); ++i) {
+		if (node_pool.subtours.size() >= NODE_POOL_SUBTOURS)
+			break;
+
+		node.subtours[i].clear();
+		node_pool.subtours.push_back(std::move(node.subtours[i]));
 	}
 
-	root.chosen_subtour = eligible_subtour;
+	node.subtours.clear();
+	node.prohibited_edges.clear();
+	node.child_bounds.clear();
+	node.next_child = 0;
+
+	if (node_pool.nodes.size() < NODE_POOL_NODES)
+		node_pool.nodes.push_back(std::move(node));
+}
+
+size_t node_memory (const Node &node) {
+	size_t bytes = sizeof(Node)
+		+ node.prohibited_edges.capacity() * sizeof(node.prohibited_edges[0])
+		+ node.subtours.capacity() * sizeof(node.subtours[0])
+		+ node.child_bounds.capacity() * sizeof(double);
+
+	for (size_t i = 0; i < node.subtours.size(); ++i) {
+		bytes += node.subtours[i].capacity() * sizeof(int);
+	}
+
+	return bytes;
 }
 
 /**
- * Turns assingment matrix into a list of subtours
+ * Empty subtour, reusing a recycled buffer when there is one
  */
-void node_get_subtours_assignment (Node &node, int **assignment_matrix, int dimension) {
-	std::vector<bool> was_visited;
+static std::vector<int> node_subtour_buffer () {
+	if (node_pool.subtours.empty())
+		return std::vector<int>();
 
-	for (int i = 0; i < dimension; ++i) {
-		was_visited.push_back(false);
-	}
+	std::vector<int> subtour = std::move(node_pool.subtours.back());
+	node_pool.subtours.pop_back();
+
+	return subtour;
+}
+
+/**
+ * Turns the successor of each city (0 based) into a list of subtours
+ */
+void node_get_subtours (Node &node, const int *successor, int dimension) {
+	std::vector<bool> &was_visited = node_pool.visited;
+	was_visited.assign(dimension, false);
 
 	for (int n = 0; n < dimension; ++n) {
 		if (was_visited[n])
@@ -95,7 +151,7 @@ void node_get_subtours_assignment (Node &node, int **assignment_matrix, int dime
 
 		int subtour_start = n;
 		int current_node = n;
-		std::vector<int> current_subtour;
+		std::vector<int> current_subtour = node_subtour_buffer();
 
 		do {
 			// insert the current node in the subtour and
@@ -105,54 +161,170 @@ void node_get_subtours_assignment (Node &node, int **assignment_matrix, int dime
 
 			// the current node is connect to another single node
 			// that we jump to
-			for (int i = 0; i < dimension; ++i) {
-				// search on current_node row
-				if (assignment_matrix[current_node][i] == 1) {
-					current_node = i;
-					break;
-				}
-			}
+			current_node = successor[current_node];
 
 		// when the node we jump to is the starting node
 		// we have completed the subtour
 		} while (current_node != subtour_start);
 
 		current_subtour.push_back(subtour_start +1);
-		node.subtours.push_back(current_subtour);
+		node.subtours.push_back(std::move(current_subtour));
 	}
 }
 
-void node_calculate_solution (Node &node, TSPInfo &tsp_info) {
-	// all prohibited edges have their cost set to infinity
-	for (size_t k = 0; k < node.prohibited_edges.size(); ++k) {
-		int i = node.prohibited_edges[k].first -1;
-		int j = node.prohibited_edges[k].second -1;
+/**
+ * Successor of each city in an assignment matrix
+ */
+static const int *node_assignment_successors (int **assignment_matrix, int dimension) {
+	std::vector<int> &successor = node_pool.successor;
+	successor.assign(dimension, 0);
 
-		tsp_info.cost_copy[i][j] = INFINITE;
+	// search on each row for the single node it is connected to
+	for (int i = 0; i < dimension; ++i) {
+		for (int j = 0; j < dimension; ++j) {
+			if (assignment_matrix[i][j] == HUNGARIAN_ASSIGNED) {
+				successor[i] = j;
+				break;
+			}
+		}
 	}
 
-	hungarian_problem_t new_problem;
-	hungarian_init(&new_problem, tsp_info.cost_copy,
-        tsp_info.dimension, tsp_info.dimension, HUNGARIAN_MODE_MINIMIZE_COST);
+	return successor.data();
+}
 
-	// the hungarian is called with the copy of the cost matrix we've changed
-	node.lower_bound = hungarian_solve(&new_problem);
+/**
+ * Turns assingment matrix into a list of subtours
+ */
+void node_get_subtours_assignment (Node &node, int **assignment_matrix, int dimension) {
+	node_get_subtours(node, node_assignment_successors(assignment_matrix, dimension), dimension);
+}
+
+void node_set_solution (Node &node, TSPInfo &tsp_info, double cost,
+		const int *successor, int **reduced_cost) {
+	node.lower_bound = cost;
 
 	// setting the subtours of our node
-	node_get_subtours_assignment(node, new_problem.assignment, tsp_info.dimension);
+	{
+		TRACE_SCOPE("subtours");
+		node_get_subtours(node, successor, tsp_info.dimension);
+	}
 
 	node.cut = node.subtours.size() == 1;
 
+	// a single subtour is a tour, its cost is exact
+	if (tsp_info.bounding == BOUNDING_ADDITIVE && !node.cut) {
+		TRACE_SCOPE("additive_bound");
+		node.lower_bound += bounding_additive(reduced_cost,
+			tsp_info.dimension, node.subtours);
+	}
+
 	// setting the chosen subtour
-	node_set_chosen_subtour(node);
+	{
+		TRACE_SCOPE("branching");
+		branching_choose_subtour(node, tsp_info, reduced_cost);
+	}
 
-	// reverting changes made to the copy matrix
-	for (size_t k = 0; k < node.prohibited_edges.size(); ++k) {
-		int i = node.prohibited_edges[k].first -1;
-		int j = node.prohibited_edges[k].second -1;
+	node.next_child = 0;
+	node.child_bounds.clear();
 
-		tsp_info.cost_copy[i][j] = tsp_info.cost_matrix[i][j];
+	// strong branching solved children in the memory of the reduced
+	// costs, they are gone
+	if (reduced_cost && !node.cut && tsp_info.branching != BRANCHING_STRONG) {
+		TRACE_SCOPE("child_bounds");
+		branching_child_bounds(node, tsp_info, cost, reduced_cost);
 	}
+}
 
-	hungarian_free(&new_problem);
+/**
+ * Row of the costs seen by the node being evaluated, i.e. with the
+ * overlay of its prohibited edges applied
+ */
+void node_cost_row (void *ctx, int row, double *out) {
+	TSPInfo &tsp_info = *(TSPInfo *) ctx;
+	tsp_prepare(tsp_info);
+
+	tsp_info.solver_costs->getRow(row, out);
+
+	const CostOverlay &overlay = tsp_info.cost_overlay;
+	for (size_t k = 0; k < overlay.size(); ++k) {
+		if (overlay.getEntry(k).i == row)
+			out[overlay.getEntry(k).j] = overlay.getEntry(k).value;
+	}
+}
+
+/**
+ * Fills `problem` with the costs seen by the node being evaluated:
+ * a copy of the shared solver costs (unpacked when symmetric),
+ * patched with the overlay entries only (instead of building every
+ * row through it)
+ */
+static void node_fill_problem (hungarian_problem_t &problem, TSPInfo &tsp_info) {
+	tsp_prepare(tsp_info);
+	hungarian_resize(&problem, tsp_info.dimension);
+	tsp_info.solver_costs->getFull(problem.cost[0]);
+
+	const CostOverlay &overlay = tsp_info.cost_overlay;
+	for (size_t k = 0; k < overlay.size(); ++k) {
+		const CostOverlay::Entry &entry = overlay.getEntry(k);
+		problem.cost[entry.i][entry.j] = entry.value;
+	}
+}
+
+void node_calculate_solution (Node &node, TSPInfo &tsp_info, double cutoff) {
+	TRACE_SCOPE("node");
+
+	// entries already in the overlay belong to the node being
+	// branched, when a child is evaluated during its branching
+	size_t overlay_base = tsp_info.cost_overlay.size();
+
+	// all prohibited edges have their cost set to infinity
+	{
+		TRACE_SCOPE("overlay");
+
+		for (size_t k = 0; k < node.prohibited_edges.size(); ++k) {
+			int i = node.prohibited_edges[k].first -1;
+			int j = node.prohibited_edges[k].second -1;
+
+			tsp_info.cost_overlay.set(i, j, INFINITE);
+		}
+	}
+
+	hungarian_problem_t &new_problem = node_pool.problem;
+	{
+		TRACE_SCOPE("hungarian_init");
+		node_fill_problem(new_problem, tsp_info);
+	}
+
+	// costs are integers, so a bound above floor(cutoff) is above
+	// the cutoff
+	int limit = HUNGARIAN_NO_CUTOFF;
+	if (cutoff < HUNGARIAN_NO_CUTOFF)
+		limit = std::floor(cutoff);
+
+	// the hungarian is called with the copy of the cost matrix we've changed
+	double cost;
+	int aborted;
+	{
+		TRACE_SCOPE("hungarian_solve");
+		MetricsSolveScope timer (METRICS_HUNGARIAN);
+		cost = hungarian_solve_cutoff(&new_problem, limit, &aborted);
+	}
+
+	if (aborted) {
+		node.lower_bound = cost;
+		node.subtours.clear();
+		node.chosen_subtour = 0;
+		node.cut = false;
+		node.next_child = 0;
+		node.child_bounds.clear();
+	} else {
+		node_set_solution(node, tsp_info, cost,
+			node_assignment_successors(new_problem.assignment, tsp_info.dimension),
+			new_problem.cost);
+	}
+
+	// reverting changes made to the costs
+	while (tsp_info.cost_overlay.size() > overlay_base) {
+		tsp_info.cost_overlay.pop();
+	}
 }
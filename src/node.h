@@ -3,8 +3,12 @@
 
 #include <vector> // vector
 #include <utility> // pair
+#include <limits> // infinity
 #include "tsp.h"
 
+// cutoff of node_calculate_solution() that never stops a solve
+#define NODE_NO_CUTOFF (std::numeric_limits<double>::infinity())
+
 typedef struct s_node Node;
 
 struct s_node {
@@ -39,9 +43,67 @@ struct s_node {
 	 * i.e. we won't branch it further
 	 */
 	bool cut;
+
+	/**
+	 * The children of the chosen subtour are created one at a time,
+	 * when the search reaches them: `next_child` is the next one
+	 * (see branching_child_edges)
+	 */
+	size_t next_child;
+
+	/**
+	 * Bound of each child before it is solved, from the reduced
+	 * costs of this node's assignment (see branching_child_bounds),
+	 * empty when they weren't available
+	 */
+	std::vector<double> child_bounds;
 };
 
-void node_calculate_solution (Node &node, TSPInfo &tsp_info);
+/**
+ * Node with empty containers, made from the memory of nodes
+ * previously given to node_recycle() on the calling thread
+ */
+Node node_new ();
+
+/**
+ * Hands the memory of a node that is no longer needed back to the
+ * calling thread's pool, `node` is left empty
+ */
+void node_recycle (Node &node);
+
+/**
+ * Bytes held by `node`, its containers included
+ */
+size_t node_memory (const Node &node);
+
+/**
+ * Evaluates `node`: solves the assignment relaxation with its
+ * prohibited edges and sets its bound and subtours
+ *
+ * The solve stops as soon as the bound is proven above `cutoff`
+ * (usually the incumbent's cost, NODE_NO_CUTOFF for none): the node
+ * is then left with that partial bound and no subtours, to be
+ * pruned.
+ */
+void node_calculate_solution (Node &node, TSPInfo &tsp_info, double cutoff);
+
+/**
+ * Sets the bound and subtours of `node` from an assignment of cost
+ * `cost`, given as the successor of each city (0 based), and the
+ * reduced costs it left (used by the additive bounding and for the
+ * bounds of the children, NULL when they weren't computed)
+ */
+void node_set_solution (Node &node, TSPInfo &tsp_info, double cost,
+	const int *successor, int **reduced_cost);
+
+/**
+ * Writes row `row` of the costs of the instance, with the entries
+ * of tsp_info.cost_overlay applied, `ctx` is the TSPInfo
+ */
+void node_cost_row (void *ctx, int row, double *out);
+
+void node_get_subtours (Node &node, const int *successor, int dimension);
+void node_get_subtours_assignment (Node &node, int **assignment_matrix, int dimension);
 
 void print_subtour (std::vector<int> &subtour);
 void print_subtours (Node &node);
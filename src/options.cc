@@ -0,0 +1,327 @@
+#include <iostream>
+#include <cstdlib> // exit(), strtod()
+#include <cstring> // strcmp(), strncmp()
+#include <algorithm> // min, max
+#include <thread> // hardware_concurrency
+#include "options.h"
+#include "search.h" // search methods
+#include "bounding.h" // bounding methods
+#include "branching.h" // branching rules
+#include "held_karp.h" // HELD_KARP_MAX
+
+#define DEFAULT_CHECKPOINT_PATH "bnb.ckpt"
+#define DEFAULT_CHECKPOINT_INTERVAL 60.0
+#define DEFAULT_DIVE_FREQUENCY 64
+#define DEFAULT_PATCH_INTERVAL 16
+#define DEFAULT_EXACT_MAX 22
+#define DEFAULT_PROBE_TIME 1.0
+#define DEFAULT_CACHE_MB 64
+
+void options_usage () {
+	std::cout << " ./bnb.out [options] [Instance]" << std::endl
+		<< "  --search best|breadth|depth|hybrid|portfolio|auto" << std::endl
+		<< "                               tree traversal method" << std::endl
+		<< "  --portfolio LIST             portfolio: strategies run at once, e.g." << std::endl
+		<< "                               hybrid,depth:additive,best:regret" << std::endl
+		<< "  --probe-time SEC             auto: seconds each candidate is probed (default 1)" << std::endl
+		<< "  --autotune-log FILE          auto: append features, probes and result to FILE" << std::endl
+		<< "  --threads N                  best: threads expanding nodes (default 1)" << std::endl
+		<< "  --helper-threads N           threads of the dynamic programming and of the" << std::endl
+		<< "                               k-d tree build (default: cores)" << std::endl
+		<< "  --checkpoint FILE            periodically save the search to FILE" << std::endl
+		<< "  --checkpoint-interval SEC    seconds between checkpoints (default 60)" << std::endl
+		<< "  --resume                     continue from the checkpoint file" << std::endl
+		<< "  --time-limit SEC             stop after SEC seconds" << std::endl
+		<< "  --node-limit N               stop after expanding N nodes" << std::endl
+		<< "  --gap G                      stop once the relative gap is at most G" << std::endl
+		<< "  --bounding ap|additive       node relaxation (default ap)" << std::endl
+		<< "  --branching smallest|regret|bound|strong" << std::endl
+		<< "                               subtour to branch on (default smallest)" << std::endl
+		<< "  --lookahead N                strong branching: candidate subtours (default 3)" << std::endl
+		<< "  --symmetric on|off           branch on undirected edges of symmetric" << std::endl
+		<< "                               instances (default on)" << std::endl
+		<< "  --dive-frequency N           hybrid: expansions between dives (default 64)" << std::endl
+		<< "  --dive-depth N               hybrid: levels per dive, 0 for no limit (default 0)" << std::endl
+		<< "  --patch-interval N           expansions between patchings of a node into a" << std::endl
+		<< "                               tour, 0 for none (default 16)" << std::endl
+		<< "  --exact-max N                solve instances of up to N cities (at most 24)" << std::endl
+		<< "                               by dynamic programming (default 22)" << std::endl
+		<< "  --trace FILE                 write a Chrome/Perfetto trace of the search" << std::endl
+		<< "  --metrics PORT               serve Prometheus metrics on 127.0.0.1:PORT" << std::endl
+		<< "  --cache DIR                  reuse and save results in the cache at DIR" << std::endl
+		<< "  --cache-size MB              size the cache is trimmed to (default 64)" << std::endl
+		<< "  --serve                      solve JSON line requests read from stdin" << std::endl
+		<< "  --socket PATH                serve the requests on a Unix socket instead" << std::endl
+		<< "  --workers N                  server: requests solved at once (default: cores)" << std::endl;
+}
+
+// names indexed by id, id 0 is none
+static const char *options_search_names[] = { NULL, "best", "breadth", "depth", "hybrid", "portfolio", "auto" };
+static const char *options_bounding_names[] = { NULL, "ap", "additive" };
+static const char *options_branching_names[] = { NULL, "smallest", "regret", "bound", "strong" };
+
+#define OPTIONS_COUNT(names) ((int) (sizeof(names) / sizeof(names[0])))
+
+static int options_lookup (const char **names, int count, const char *name) {
+	for (int id = 1; id < count; ++id) {
+		if (strcmp(name, names[id]) == 0)
+			return id;
+	}
+
+	return 0;
+}
+
+int options_search_id (const char *name) {
+	return options_lookup(options_search_names, OPTIONS_COUNT(options_search_names), name);
+}
+
+int options_bounding_id (const char *name) {
+	return options_lookup(options_bounding_names, OPTIONS_COUNT(options_bounding_names), name);
+}
+
+int options_branching_id (const char *name) {
+	return options_lookup(options_branching_names, OPTIONS_COUNT(options_branching_names), name);
+}
+
+int options_helper_threads (const Options &options) {
+	if (options.helper_threads > 0)
+		return options.helper_threads;
+
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::string options_strategy_name (const Strategy &strategy) {
+	return std::string(options_search_names[strategy.search])
+		+ ":" + options_bounding_names[strategy.bounding]
+		+ ":" + options_branching_names[strategy.branching];
+}
+
+/**
+ * Parses a comma separated list of strategies, each one naming
+ * its search, bounding and branching in any order, separated by
+ * colons (e.g. "hybrid,depth:additive,best:regret"); whatever
+ * isn't named is taken from `options`
+ */
+static void options_portfolio (Options &options, const char *list) {
+	std::string text = list;
+	size_t start = 0;
+
+	options.portfolio.clear();
+
+	while (start <= text.size()) {
+		size_t end = text.find(',', start);
+		if (end == std::string::npos)
+			end = text.size();
+
+		Strategy strategy;
+		strategy.search = 0;
+		strategy.bounding = options.bounding;
+		strategy.branching = options.branching;
+
+		size_t part = start;
+		while (part <= end) {
+			size_t part_end = std::min(text.find(':', part), end);
+			std::string name = text.substr(part, part_end - part);
+			int id;
+
+			if ((id = options_search_id(name.c_str())) && id < PORTFOLIO_SEARCH)
+				strategy.search = id;
+			else if ((id = options_bounding_id(name.c_str())))
+				strategy.bounding = id;
+			else if ((id = options_branching_id(name.c_str())))
+				strategy.branching = id;
+			else {
+				std::cout << "Unknown portfolio strategy part: " << name << std::endl;
+				exit(EXIT_FAILURE);
+			}
+
+			part = part_end + 1;
+		}
+
+		if (!strategy.search) {
+			std::cout << "Portfolio strategy without a search method: "
+				<< text.substr(start, end - start) << std::endl;
+			exit(EXIT_FAILURE);
+		}
+
+		options.portfolio.push_back(strategy);
+		start = end + 1;
+	}
+}
+
+/**
+ * Returns the value following option `argv[i]` and advances `i`,
+ * exiting when the option is the last argument
+ */
+static char *options_value (int &i, int argc, char **argv) {
+	if (i + 1 >= argc) {
+		std::cout << "Missing value for " << argv[i] << std::endl;
+		options_usage();
+		exit(EXIT_FAILURE);
+	}
+
+	return argv[++i];
+}
+
+static double options_number (const char *option, const char *value) {
+	char *end;
+	double number = strtod(value, &end);
+
+	if (*value == '\0' || *end != '\0' || number < 0) {
+		std::cout << "Invalid value for " << option << ": " << value << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	return number;
+}
+
+void options_parse (Options &options, int argc, char **argv) {
+	options.args.clear();
+	options.args.push_back(argv[0]);
+	options.search = 0;
+	options.checkpoint_path.clear();
+	options.checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+	options.resume = false;
+	options.time_limit = 0;
+	options.node_limit = 0;
+	options.gap = -1;
+	options.bounding = BOUNDING_AP;
+	options.branching = BRANCHING_SMALLEST;
+	options.lookahead = DEFAULT_LOOKAHEAD;
+	options.symmetric = true;
+	options.dive_frequency = DEFAULT_DIVE_FREQUENCY;
+	options.dive_depth = 0;
+	options.patch_interval = DEFAULT_PATCH_INTERVAL;
+	options.exact_max = DEFAULT_EXACT_MAX;
+	options.threads = 1;
+	options.helper_threads = 0;
+	options.probe_time = DEFAULT_PROBE_TIME;
+	options.autotune_log.clear();
+	options.trace_path.clear();
+	options.metrics_port = 0;
+	options.portfolio.clear();
+	options.cache_dir.clear();
+	options.cache_size = DEFAULT_CACHE_MB << 20;
+	options.quiet = false;
+	options.serve = false;
+	options.socket_path.clear();
+	options.workers = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		const char *arg = argv[i];
+
+		if (strncmp(arg, "--", 2) != 0) {
+			options.args.push_back(argv[i]);
+		} else if (strcmp(arg, "--search") == 0) {
+			const char *value = options_value(i, argc, argv);
+
+			options.search = options_search_id(value);
+			if (!options.search) {
+				std::cout << "Unknown search method: " << value << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(arg, "--portfolio") == 0) {
+			options_portfolio(options, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--probe-time") == 0) {
+			options.probe_time = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--autotune-log") == 0) {
+			options.autotune_log = options_value(i, argc, argv);
+		} else if (strcmp(arg, "--threads") == 0) {
+			options.threads = options_number(arg, options_value(i, argc, argv));
+			if (options.threads < 1)
+				options.threads = 1;
+		} else if (strcmp(arg, "--helper-threads") == 0) {
+			options.helper_threads = options_number(arg, options_value(i, argc, argv));
+			if (options.helper_threads < 0)
+				options.helper_threads = 0;
+		} else if (strcmp(arg, "--checkpoint") == 0) {
+			options.checkpoint_path = options_value(i, argc, argv);
+		} else if (strcmp(arg, "--checkpoint-interval") == 0) {
+			options.checkpoint_interval = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--resume") == 0) {
+			options.resume = true;
+		} else if (strcmp(arg, "--time-limit") == 0) {
+			options.time_limit = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--node-limit") == 0) {
+			options.node_limit = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--gap") == 0) {
+			options.gap = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--bounding") == 0) {
+			const char *value = options_value(i, argc, argv);
+
+			options.bounding = options_bounding_id(value);
+			if (!options.bounding) {
+				std::cout << "Unknown bounding method: " << value << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(arg, "--branching") == 0) {
+			const char *value = options_value(i, argc, argv);
+
+			options.branching = options_branching_id(value);
+			if (!options.branching) {
+				std::cout << "Unknown branching rule: " << value << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(arg, "--lookahead") == 0) {
+			options.lookahead = options_number(arg, options_value(i, argc, argv));
+			if (options.lookahead < 1)
+				options.lookahead = 1;
+		} else if (strcmp(arg, "--symmetric") == 0) {
+			const char *value = options_value(i, argc, argv);
+
+			if (strcmp(value, "on") == 0)
+				options.symmetric = true;
+			else if (strcmp(value, "off") == 0)
+				options.symmetric = false;
+			else {
+				std::cout << "Invalid value for " << arg << ": " << value << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(arg, "--dive-frequency") == 0) {
+			options.dive_frequency = options_number(arg, options_value(i, argc, argv));
+			if (options.dive_frequency < 1)
+				options.dive_frequency = 1;
+		} else if (strcmp(arg, "--dive-depth") == 0) {
+			options.dive_depth = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--patch-interval") == 0) {
+			options.patch_interval = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--exact-max") == 0) {
+			const char *value = options_value(i, argc, argv);
+			double exact_max = options_number(arg, value);
+
+			if (exact_max > HELD_KARP_MAX) {
+				std::cout << "Invalid value for " << arg << ": " << value
+					<< " (dynamic programming solves at most " << HELD_KARP_MAX << " cities)" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+
+			options.exact_max = exact_max;
+		} else if (strcmp(arg, "--trace") == 0) {
+			options.trace_path = options_value(i, argc, argv);
+		} else if (strcmp(arg, "--metrics") == 0) {
+			options.metrics_port = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--cache") == 0) {
+			options.cache_dir = options_value(i, argc, argv);
+		} else if (strcmp(arg, "--cache-size") == 0) {
+			options.cache_size = options_number(arg, options_value(i, argc, argv)) * (1 << 20);
+		} else if (strcmp(arg, "--serve") == 0) {
+			options.serve = true;
+		} else if (strcmp(arg, "--socket") == 0) {
+			options.serve = true;
+			options.socket_path = options_value(i, argc, argv);
+		} else if (strcmp(arg, "--workers") == 0) {
+			options.workers = options_number(arg, options_value(i, argc, argv));
+		} else if (strcmp(arg, "--help") == 0) {
+			options_usage();
+			exit(EXIT_SUCCESS);
+		} else {
+			std::cout << "Unknown option: " << arg << std::endl;
+			options_usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// resuming without naming a file reads the default one
+	if (options.resume && options.checkpoint_path.empty())
+		options.checkpoint_path = DEFAULT_CHECKPOINT_PATH;
+}
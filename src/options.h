@@ -0,0 +1,179 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <string> // string
+#include <vector> // vector
+
+typedef struct s_options Options;
+
+/**
+ * Search method, bounding and branching of one search of a
+ * portfolio
+ */
+typedef struct s_strategy {
+	int search;
+	int bounding;
+	int branching;
+} Strategy;
+
+struct s_options {
+	/**
+	 * Positional arguments (program name included), in the
+	 * layout `Data` expects for its argc/argv check
+	 */
+	std::vector<char *> args;
+
+	/**
+	 * Tree traversal method, 0 when it should be asked
+	 * at the prompt
+	 */
+	int search;
+
+	/**
+	 * File the open frontier, incumbent and statistics are
+	 * periodically saved to, empty when checkpointing is off
+	 */
+	std::string checkpoint_path;
+
+	/**
+	 * Seconds between two checkpoints
+	 */
+	double checkpoint_interval;
+
+	/**
+	 * Continue from the checkpoint at `checkpoint_path` instead
+	 * of starting from the root
+	 */
+	bool resume;
+
+	/**
+	 * Stopping criteria, the search returns its incumbent as soon
+	 * as one is met: wall-clock seconds of this run, nodes expanded
+	 * by this run and relative gap between the incumbent and the
+	 * global lower bound (0 disables the limits, a negative gap
+	 * disables the gap check)
+	 */
+	double time_limit;
+	long node_limit;
+	double gap;
+
+	/**
+	 * Relaxation used for the node bounds, see bounding.h
+	 */
+	int bounding;
+
+	/**
+	 * Rule choosing the subtour to branch on and candidates
+	 * evaluated by strong branching, see branching.h
+	 */
+	int branching;
+	int lookahead;
+
+	/**
+	 * Branch on undirected edges when the instance is symmetric (see
+	 * branching_child_edges)
+	 */
+	bool symmetric;
+
+	/**
+	 * Hybrid search: best-first expansions between two dives and
+	 * levels a dive may go down (0 for no limit), both adapted
+	 * during the search
+	 */
+	long dive_frequency;
+	long dive_depth;
+
+	/**
+	 * Nodes expanded between two patchings of a node's subtours
+	 * into a tour (see patching.h), 0 to never patch
+	 */
+	long patch_interval;
+
+	/**
+	 * Instances of at most this many cities are solved by dynamic
+	 * programming instead of searched (see held_karp.h), 0 never
+	 */
+	int exact_max;
+
+	/**
+	 * Threads of the best-bound search (see search_best)
+	 */
+	int threads;
+
+	/**
+	 * Threads the dynamic programming and the k-d tree build of a
+	 * solve may use, 0 for one per core (see options_helper_threads)
+	 */
+	int helper_threads;
+
+	/**
+	 * Autotuning search: seconds each candidate strategy is probed
+	 * for, and file its choices are logged to (empty for none)
+	 */
+	double probe_time;
+	std::string autotune_log;
+
+	/**
+	 * Chrome trace file of the search, empty when tracing is off
+	 */
+	std::string trace_path;
+
+	/**
+	 * Strategies the portfolio search runs at once, empty for its
+	 * default list (see search_portfolio)
+	 */
+	std::vector<Strategy> portfolio;
+
+	/**
+	 * Port of the Prometheus metrics endpoint on localhost (see
+	 * metrics.h), 0 when it is off
+	 */
+	int metrics_port;
+
+	/**
+	 * Directory of the result cache (see cache.h), empty when the
+	 * cache is off, and the bytes it may take
+	 */
+	std::string cache_dir;
+	long cache_size;
+
+	/**
+	 * Don't report the incumbents as they are found, only the
+	 * final result is wanted (set for server requests)
+	 */
+	bool quiet;
+
+	/**
+	 * Server mode: solve JSON line requests read from stdin or, when
+	 * `socket_path` is set, from the connections to that Unix socket
+	 * on `workers` threads (see server.h)
+	 */
+	bool serve;
+	std::string socket_path;
+	int workers;
+};
+
+void options_parse (Options &options, int argc, char **argv);
+
+void options_usage ();
+
+/**
+ * Ids of the search methods, bounding methods and branching rules
+ * named as on the command line, 0 for an unknown name
+ */
+int options_search_id (const char *name);
+int options_bounding_id (const char *name);
+int options_branching_id (const char *name);
+
+/**
+ * Threads the helpers of a solve may use: `helper_threads`, or one
+ * per core when it is 0
+ */
+int options_helper_threads (const Options &options);
+
+/**
+ * e.g. "hybrid:ap:smallest"
+ */
+std::string options_strategy_name (const Strategy &strategy);
+
+#endif
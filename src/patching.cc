@@ -0,0 +1,95 @@
+#include <vector> // vector
+#include "patching.h"
+#include "data.h" // INFINITE
+
+double patching_tour (TSPInfo &tsp_info, const Node &node, std::vector<int> &tour) {
+	tsp_prepare(tsp_info);
+
+	int n = tsp_info.dimension;
+	const SolverCosts &cost = *tsp_info.solver_costs;
+	const std::vector< std::vector<int> > &subtours = node.subtours;
+
+	// the tour grows from the largest subtour, as the successor of
+	// each city (0 based), `patched` marks the cities already in it
+	std::vector<int> successor (n);
+	std::vector<bool> patched (n, false);
+	size_t largest = 0;
+
+	for (size_t s = 0; s < subtours.size(); ++s) {
+		const std::vector<int> &subtour = subtours[s];
+
+		for (size_t i = 0; i +1 < subtour.size(); ++i) {
+			successor[subtour[i] -1] = subtour[i +1] -1;
+		}
+
+		if (subtour.size() > subtours[largest].size())
+			largest = s;
+	}
+
+	std::vector<int> members;
+	for (size_t i = 0; i +1 < subtours[largest].size(); ++i) {
+		members.push_back(subtours[largest][i] -1);
+		patched[subtours[largest][i] -1] = true;
+	}
+
+	while ((int) members.size() < n) {
+		long long best_delta = 0;
+		int best_a = -1;
+		int best_b = -1;
+
+		for (size_t k = 0; k < members.size(); ++k) {
+			int a = members[k];
+			int next_a = successor[a];
+			long long removed_a = cost.get(a, next_a);
+
+			for (int b = 0; b < n; ++b) {
+				if (patched[b])
+					continue;
+
+				int next_b = successor[b];
+				long long delta = (long long) cost.get(a, next_b) + cost.get(b, next_a)
+					- removed_a - cost.get(b, next_b);
+
+				if (best_a < 0 || delta < best_delta) {
+					best_delta = delta;
+					best_a = a;
+					best_b = b;
+				}
+			}
+		}
+
+		// the subtour of b joins the tour
+		int a = best_a;
+		int next_a = successor[a];
+		int b = best_b;
+
+		do {
+			patched[b] = true;
+			members.push_back(b);
+			b = successor[b];
+		} while (b != best_b);
+
+		successor[a] = successor[b];
+		successor[b] = next_a;
+	}
+
+	tour.clear();
+	long long length = 0;
+	int city = 0;
+
+	do {
+		int next = successor[city];
+		int arc = cost.get(city, next);
+
+		if (arc >= INFINITE)
+			return INFINITE;
+
+		tour.push_back(city +1);
+		length += arc;
+		city = next;
+	} while (city != 0);
+
+	tour.push_back(1);
+
+	return length;
+}
@@ -0,0 +1,24 @@
+#ifndef PATCHING_H
+#define PATCHING_H
+
+#include <vector> // vector
+#include "tsp.h"
+#include "node.h"
+
+/**
+ * Karp's patching heuristic: turns the subtours of the assignment
+ * of `node` into a tour of the whole instance
+ *
+ * Starting from the largest subtour, the subtour that is cheapest
+ * to patch in is merged into it, one at a time: an arc (a, a') of
+ * the tour and an arc (b, b') of the subtour are exchanged for
+ * (a, b') and (b, a'). The prohibited edges of the node are not
+ * enforced, any tour of the instance is a valid incumbent.
+ *
+ * Writes the tour to `tour` (1 based and closed, like the subtours)
+ * and returns its cost, INFINITE when it has to use an arc that
+ * can't be used.
+ */
+double patching_tour (TSPInfo &tsp_info, const Node &node, std::vector<int> &tour);
+
+#endif
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <vector> // vector
+#include <thread> // thread
+#include <algorithm> // min, max
+#include "search.h"
+#include "bounding.h"
+#include "branching.h"
+
+/**
+ * Strategies of the default portfolio, the most often useful first:
+ * the list is cut to the number of cores
+ */
+static const Strategy portfolio_default[] = {
+	{ HYBRID_SEARCH, BOUNDING_AP, BRANCHING_SMALLEST },
+	{ DEPTH_FIRST_SEARCH, BOUNDING_ADDITIVE, BRANCHING_SMALLEST },
+	{ BEST_BOUND_SEARCH, BOUNDING_AP, BRANCHING_REGRET },
+	{ HYBRID_SEARCH, BOUNDING_ADDITIVE, BRANCHING_BOUND },
+	{ BEST_BOUND_SEARCH, BOUNDING_ADDITIVE, BRANCHING_SMALLEST },
+	{ DEPTH_FIRST_SEARCH, BOUNDING_AP, BRANCHING_STRONG },
+	{ HYBRID_SEARCH, BOUNDING_AP, BRANCHING_STRONG },
+	{ BREADTH_FIRST_SEARCH, BOUNDING_AP, BRANCHING_SMALLEST },
+};
+
+// the default portfolio runs at least this many strategies, even
+// on fewer cores
+#define PORTFOLIO_MIN_DEFAULT 2
+
+typedef struct s_portfolio_member {
+	Strategy strategy;
+	TSPInfo tsp_info;
+	Options options;
+} PortfolioMember;
+
+static void portfolio_run (PortfolioMember *member) {
+	search_run(member->strategy.search, member->tsp_info, member->options, NULL);
+}
+
+void search_portfolio (TSPInfo &tsp_info, Options &options) {
+	std::vector<Strategy> strategies = options.portfolio;
+
+	if (strategies.empty()) {
+		int available = sizeof(portfolio_default) / sizeof(portfolio_default[0]);
+		int cores = std::thread::hardware_concurrency();
+		int count = std::min(available, std::max(PORTFOLIO_MIN_DEFAULT, cores));
+
+		strategies.assign(portfolio_default, portfolio_default + count);
+	}
+
+	SearchShared shared;
+	shared.upper_bound = tsp_info.upper_bound;
+	shared.best_tour = tsp_info.best_tour;
+	shared.finished = false;
+
+	// each member searches its own copy of the TSPInfo, which
+	// carries its own overlay, bounds and statistics, but they all
+	// read the same matrix and solver costs
+	tsp_prepare(tsp_info);
+	std::vector<PortfolioMember> members (strategies.size());
+
+	for (size_t i = 0; i < members.size(); ++i) {
+		PortfolioMember &member = members[i];
+
+		member.strategy = strategies[i];
+		member.tsp_info = tsp_info;
+		member.tsp_info.shared = &shared;
+		member.tsp_info.bounding = member.strategy.bounding;
+		member.tsp_info.branching = member.strategy.branching;
+
+		member.options = options;
+		member.options.search = member.strategy.search;
+		member.options.bounding = member.strategy.bounding;
+		member.options.branching = member.strategy.branching;
+		// refused on the command line, a server request has none
+		member.options.checkpoint_path.clear();
+
+		// the members already take the cores
+		member.options.helper_threads = 1;
+		member.options.resume = false;
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < members.size(); ++i) {
+		threads.push_back(std::thread(portfolio_run, &members[i]));
+	}
+
+	portfolio_run(&members[0]);
+
+	for (size_t t = 0; t < threads.size(); ++t) {
+		threads[t].join();
+	}
+
+	// every member's bound is valid, the best one is kept, and the
+	// status is that of the member which finished (else the first)
+	tsp_info.upper_bound = shared.upper_bound;
+	tsp_info.best_tour = shared.best_tour;
+	tsp_info.lower_bound = 0;
+	tsp_info.status = members[0].tsp_info.status;
+	tsp_info.stats = SearchStats();
+
+	int winner = -1;
+
+	for (size_t i = 0; i < members.size(); ++i) {
+		const TSPInfo &result = members[i].tsp_info;
+
+		tsp_info.lower_bound = std::max(tsp_info.lower_bound, result.lower_bound);
+		tsp_info.stats.expanded += result.stats.expanded;
+		tsp_info.stats.generated += result.stats.generated;
+		tsp_info.stats.elapsed = std::max(tsp_info.stats.elapsed, result.stats.elapsed);
+
+		if (winner < 0 && (result.status == SEARCH_COMPLETE || result.status == SEARCH_GAP_LIMIT)) {
+			winner = i;
+			tsp_info.status = result.status;
+		}
+	}
+
+	if (tsp_info.status == SEARCH_COMPLETE || tsp_info.lower_bound > tsp_info.upper_bound)
+		tsp_info.lower_bound = tsp_info.upper_bound;
+
+	if (!options.quiet && winner >= 0)
+		std::cout << "Portfolio: " << options_strategy_name(members[winner].strategy)
+			<< " finished first" << std::endl;
+}
@@ -0,0 +1,1695 @@
+#include <iostream>
+#include <vector> // vector
+#include <utility> // pair, move
+#include <chrono> // checkpoint interval
+#include <algorithm> // push_heap, pop_heap, min, max
+#include <limits> // infinity
+#include <new> // bad_alloc
+#include <thread> // thread
+#include <condition_variable> // condition_variable
+#include "search.h"
+#include "node.h"
+#include "data.h" // INFINITE
+#include "assignment.h"
+#include "bounding.h"
+#include "branching.h"
+#include "patching.h"
+#include "held_karp.h"
+#include "multiqueue.h"
+#include "metrics.h"
+#include "trace.h"
+
+// nodes expanded between two gap checks of the list based searches
+#define GAP_CHECK_INTERVAL 256
+
+// largest share of the search time spent copying the frontier into
+// checkpoints, the wait between two of them is stretched to stay
+// below it
+#define CHECKPOINT_MAX_PAUSE 0.05
+
+// heaps of the multiqueue per thread of the parallel best-bound
+// search
+#define PARALLEL_QUEUES_PER_THREAD 4
+
+// the dive frequency of search_hybrid adapts within this factor of
+// the one it was given
+#define DIVE_FREQUENCY_RANGE 16
+
+typedef std::chrono::steady_clock Clock;
+
+// Custom compare for priority_queue
+class Compare
+{
+	public:
+	    bool operator() (const Node &a, const Node &b) const {
+		    return a.lower_bound > b.lower_bound;
+		}
+};
+
+/**
+ * Binary heap of open nodes, lowest bound on top: a priority_queue
+ * that nodes can be moved out of, and whose nodes can be
+ * checkpointed
+ */
+class NodeQueue
+{
+	public:
+		void push (Node &&node) {
+			heap.push_back(std::move(node));
+			std::push_heap(heap.begin(), heap.end(), Compare());
+		}
+
+		Node pop () {
+			std::pop_heap(heap.begin(), heap.end(), Compare());
+			Node node = std::move(heap.back());
+			heap.pop_back();
+
+			return node;
+		}
+
+		const Node &top () const {
+			return heap.front();
+		}
+
+		size_t size () const {
+			return heap.size();
+		}
+
+		const std::vector<Node> &nodes () const {
+			return heap;
+		}
+
+	private:
+		std::vector<Node> heap;
+};
+
+/**
+ * First in first out queue of open nodes kept in a single vector:
+ * popped slots are left behind `head` and reclaimed in bulk once
+ * they make up half of the vector
+ */
+class NodeFifo
+{
+	public:
+		NodeFifo () : head(0) {}
+
+		void push (Node &&node) {
+			nodes.push_back(std::move(node));
+		}
+
+		Node pop () {
+			Node node = std::move(nodes[head++]);
+
+			if (head * 2 >= nodes.size()) {
+				nodes.erase(nodes.begin(), nodes.begin() + head);
+				head = 0;
+			}
+
+			return node;
+		}
+
+		size_t size () const {
+			return nodes.size() - head;
+		}
+
+		std::vector<Node>::const_iterator begin () const {
+			return nodes.begin() + head;
+		}
+
+		std::vector<Node>::const_iterator end () const {
+			return nodes.end();
+		}
+
+	private:
+		std::vector<Node> nodes;
+		size_t head;
+};
+
+/**
+ * State of one call to a search_* function: limits, timing
+ * and periodic checkpoints
+ */
+typedef struct s_search_run {
+	int search;
+	Options *options;
+
+	/**
+	 * Seconds and nodes already spent by the runs this one resumed
+	 */
+	double elapsed_before;
+	long expanded_before;
+
+	/**
+	 * Set when the incumbent improved since the last gap check
+	 */
+	bool incumbent_changed;
+
+	/**
+	 * Tour built by the last patching of a node
+	 */
+	std::vector<int> patched_tour;
+
+	Clock::time_point start;
+	Clock::time_point last_checkpoint;
+
+	bool checkpointing;
+	CheckpointWriter writer;
+
+	/**
+	 * Seconds from one checkpoint to the next: the interval asked
+	 * for, or more when snapshots of a large frontier take long
+	 */
+	double checkpoint_wait;
+
+	/**
+	 * Metrics record of the thread, NULL when metrics are off
+	 */
+	MetricsThread *metrics;
+} SearchRun;
+
+static double seconds_between (Clock::time_point from, Clock::time_point to) {
+	return std::chrono::duration<double>(to - from).count();
+}
+
+double search_gap (double upper_bound, double lower_bound) {
+	if (upper_bound >= INFINITE)
+		return std::numeric_limits<double>::infinity();
+
+	if (upper_bound <= lower_bound || upper_bound == 0)
+		return 0;
+
+	return (upper_bound - lower_bound) / upper_bound;
+}
+
+const char *search_status_name (int status) {
+	switch (status) {
+	case SEARCH_TIME_LIMIT:
+		return "time_limit";
+	case SEARCH_NODE_LIMIT:
+		return "node_limit";
+	case SEARCH_GAP_LIMIT:
+		return "gap_limit";
+	case SEARCH_STOPPED:
+		return "stopped";
+	}
+
+	return "optimal";
+}
+
+/**
+ * Lowest lower bound among the nodes in [first, last), the
+ * incumbent's cost if they are all above it
+ */
+template <typename Iterator>
+static double search_lower_bound (TSPInfo &tsp_info, Iterator first, Iterator last) {
+	double lower_bound = tsp_info.upper_bound;
+
+	for (Iterator it = first; it != last; ++it) {
+		if (it->lower_bound < lower_bound)
+			lower_bound = it->lower_bound;
+	}
+
+	return lower_bound;
+}
+
+static void search_report (SearchRun &run, TSPInfo &tsp_info) {
+	if (run.options->quiet)
+		return;
+
+	std::streamsize precision = std::cout.precision(17);
+	std::cout << "Incumbent: " << tsp_info.upper_bound;
+	std::cout.precision(precision);
+
+	std::cout << " after " << seconds_between(run.start, Clock::now()) << " seconds, "
+		<< tsp_info.stats.expanded << " nodes" << std::endl;
+	std::cout << "Tour: ";
+	print_subtour(tsp_info.best_tour);
+}
+
+/**
+ * Makes `tour`, of cost `cost`, the incumbent and reports it, in a
+ * portfolio only when it also beats the other searches' one
+ */
+static void search_incumbent (SearchRun &run, TSPInfo &tsp_info,
+		const std::vector<int> &tour, double cost) {
+	tsp_info.best_tour = tour;
+	tsp_info.upper_bound = cost;
+	run.incumbent_changed = true;
+	trace_instant("incumbent", tsp_info.upper_bound);
+
+	if (!tsp_info.shared) {
+		search_report(run, tsp_info);
+		return;
+	}
+
+	SearchShared &shared = *tsp_info.shared;
+	std::lock_guard<std::mutex> lock (shared.mutex);
+
+	if (tsp_info.upper_bound < shared.upper_bound) {
+		shared.upper_bound = tsp_info.upper_bound;
+		shared.best_tour = tsp_info.best_tour;
+
+		// under the lock, so the reports don't interleave
+		search_report(run, tsp_info);
+	}
+}
+
+/**
+ * Makes the tour of `node`, a node that was cut, the incumbent
+ */
+static void search_incumbent (SearchRun &run, TSPInfo &tsp_info, Node &node) {
+	search_incumbent(run, tsp_info, node.subtours[node.chosen_subtour], node.lower_bound);
+}
+
+/**
+ * Patches the subtours of `node` into a tour (see patching.h), which
+ * becomes the incumbent if it is better
+ *
+ * Nodes that are tours already, or whose solve was cut off, have
+ * nothing to patch.
+ */
+static void search_patch (SearchRun &run, TSPInfo &tsp_info, const Node &node) {
+	if (node.cut || node.subtours.size() < 2)
+		return;
+
+	TRACE_SCOPE("patch");
+
+	double cost = patching_tour(tsp_info, node, run.patched_tour);
+
+	if (cost < tsp_info.upper_bound)
+		search_incumbent(run, tsp_info, run.patched_tour, cost);
+}
+
+/**
+ * Whether the node expanded last is due to be patched: one node
+ * every `patch_interval` expansions
+ */
+static bool search_patch_due (SearchRun &run, TSPInfo &tsp_info) {
+	long interval = run.options->patch_interval;
+
+	return interval > 0 && tsp_info.stats.expanded % interval == 0;
+}
+
+/**
+ * Takes the incumbent of the other searches of the portfolio when
+ * it is better, returns true once one of them finished
+ */
+static bool search_sync (SearchRun &run, TSPInfo &tsp_info) {
+	SearchShared &shared = *tsp_info.shared;
+
+	if (shared.finished.load(std::memory_order_relaxed))
+		return true;
+
+	if (shared.upper_bound.load(std::memory_order_relaxed) < tsp_info.upper_bound) {
+		std::lock_guard<std::mutex> lock (shared.mutex);
+
+		tsp_info.upper_bound = shared.upper_bound;
+		tsp_info.best_tour = shared.best_tour;
+		run.incumbent_changed = true;
+	}
+
+	return false;
+}
+
+/**
+ * Prepares `tsp_info` for a new search and fills `seed` with the
+ * nodes the tree starts with: the evaluated root, or the frontier
+ * of `resume` along with its incumbent and statistics
+ *
+ * A new search keeps the incumbent already in `tsp_info` (e.g. one
+ * from the result cache), it is cleared by setting the upper bound
+ * to INFINITE.
+ */
+static void search_start (SearchRun &run, TSPInfo &tsp_info,
+		Options &options, int search, Checkpoint *resume, std::vector<Node> &seed) {
+	run.search = search;
+	run.options = &options;
+	run.incumbent_changed = false;
+	run.checkpointing = !options.checkpoint_path.empty();
+	run.writer.path = options.checkpoint_path;
+	run.start = Clock::now();
+	run.last_checkpoint = run.start;
+	run.checkpoint_wait = options.checkpoint_interval;
+	run.metrics = NULL;
+
+	if (metrics_enabled) {
+		run.metrics = &metrics_thread();
+		metrics_search_begin(*run.metrics, tsp_info.solve);
+	}
+
+	tsp_info.status = SEARCH_COMPLETE;
+
+	if (resume) {
+		tsp_info.upper_bound = resume->upper_bound;
+		tsp_info.best_tour = resume->best_tour;
+		tsp_info.stats = resume->stats;
+		seed = resume->frontier;
+	} else {
+		if (tsp_info.upper_bound >= INFINITE)
+			tsp_info.best_tour.clear();
+		tsp_info.stats = SearchStats();
+
+		Node root;
+		node_calculate_solution(root, tsp_info, NODE_NO_CUTOFF);
+		++tsp_info.stats.generated;
+
+		// an assignment that is already a tour is optimal
+		if (root.cut) {
+			if (root.lower_bound < tsp_info.upper_bound)
+				search_incumbent(run, tsp_info, root);
+		} else {
+			if (options.patch_interval > 0)
+				search_patch(run, tsp_info, root);
+
+			seed.push_back(std::move(root));
+		}
+	}
+
+	run.elapsed_before = tsp_info.stats.elapsed;
+	run.expanded_before = tsp_info.stats.expanded;
+}
+
+/**
+ * Checks the stopping criteria of the run, `lower_bound` is only
+ * called when the gap has to be measured
+ */
+template <typename LowerBound>
+static bool search_should_stop (SearchRun &run, TSPInfo &tsp_info, LowerBound lower_bound) {
+	Options &options = *run.options;
+
+	if (tsp_info.shared && search_sync(run, tsp_info)) {
+		tsp_info.status = SEARCH_STOPPED;
+		return true;
+	}
+
+	if (options.node_limit > 0
+			&& tsp_info.stats.expanded - run.expanded_before >= options.node_limit) {
+		tsp_info.status = SEARCH_NODE_LIMIT;
+		return true;
+	}
+
+	if (options.time_limit > 0
+			&& seconds_between(run.start, Clock::now()) >= options.time_limit) {
+		tsp_info.status = SEARCH_TIME_LIMIT;
+		return true;
+	}
+
+	// measuring the gap may walk the whole tree, so it is only done
+	// when the incumbent changes and every GAP_CHECK_INTERVAL nodes
+	if (options.gap >= 0 && tsp_info.upper_bound < INFINITE
+			&& (run.incumbent_changed || tsp_info.stats.expanded % GAP_CHECK_INTERVAL == 0)) {
+		run.incumbent_changed = false;
+
+		if (search_gap(tsp_info.upper_bound, lower_bound()) <= options.gap) {
+			tsp_info.status = SEARCH_GAP_LIMIT;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Whether the next checkpoint is due: its wait went by since the
+ * last save, and that one is written (a slow disk delays the next
+ * snapshot instead of stopping the search)
+ */
+static bool search_checkpoint_due (SearchRun &run) {
+	return run.checkpointing && !checkpoint_writer_busy(run.writer)
+		&& seconds_between(run.last_checkpoint, Clock::now()) >= run.checkpoint_wait;
+}
+
+/**
+ * Saves the nodes in [first, last) as the open frontier once the
+ * checkpoint is due, or right away when `force` is set
+ *
+ * The whole frontier is copied on the search thread, so the wait
+ * until the next checkpoint grows with the time the copy took: the
+ * search spends at most CHECKPOINT_MAX_PAUSE of its time on them.
+ */
+template <typename Iterator>
+static void search_checkpoint (SearchRun &run, TSPInfo &tsp_info,
+		Iterator first, Iterator last, bool force) {
+	if (!run.checkpointing || !(force || search_checkpoint_due(run)))
+		return;
+
+	Clock::time_point now = Clock::now();
+	tsp_info.stats.elapsed = run.elapsed_before + seconds_between(run.start, now);
+
+	Checkpoint checkpoint;
+	checkpoint.search = run.search;
+	checkpoint.dimension = tsp_info.dimension;
+	checkpoint.upper_bound = tsp_info.upper_bound;
+	checkpoint.best_tour = tsp_info.best_tour;
+	checkpoint.stats = tsp_info.stats;
+
+	for (Iterator it = first; it != last; ++it) {
+		checkpoint_add_node(checkpoint, *it);
+	}
+
+	checkpoint_writer_submit(run.writer, std::move(checkpoint));
+
+	run.last_checkpoint = Clock::now();
+	run.checkpoint_wait = std::max(run.options->checkpoint_interval,
+		seconds_between(now, run.last_checkpoint) / CHECKPOINT_MAX_PAUSE);
+}
+
+/**
+ * Whether a metrics scrape waits for the progress of the run
+ */
+static bool search_metrics_due (SearchRun &run) {
+	return run.metrics && metrics_requested(*run.metrics);
+}
+
+/**
+ * Publishes the progress of the run to its metrics record: `open`
+ * nodes of lowest bound `lower_bound` taking `bytes`
+ */
+static void search_publish (SearchRun &run, TSPInfo &tsp_info, long open,
+		double lower_bound, double bytes) {
+	MetricsThread &metrics = *run.metrics;
+
+	metrics.expanded = tsp_info.stats.expanded - run.expanded_before;
+	metrics.generated = tsp_info.stats.generated;
+	metrics.upper_bound = tsp_info.upper_bound;
+	metrics.open = open;
+	metrics.lower_bound = lower_bound;
+	metrics.frontier_bytes = bytes;
+}
+
+/**
+ * search_publish for the open nodes in [first, last)
+ */
+template <typename Iterator>
+static void search_publish (SearchRun &run, TSPInfo &tsp_info, Iterator first, Iterator last) {
+	long open = 0;
+	double bytes = 0;
+
+	for (Iterator it = first; it != last; ++it) {
+		++open;
+		bytes += node_memory(*it);
+	}
+
+	search_publish(run, tsp_info, open, search_lower_bound(tsp_info, first, last), bytes);
+}
+
+/**
+ * Records the global lower bound and the time spent, and when
+ * checkpointing saves the nodes left in [first, last) (an empty
+ * frontier marks a finished search)
+ *
+ * Only an exhaustive search, one that left no open node, proves its
+ * incumbent: a run that ends with nodes left for any other reason
+ * than a limit returns SEARCH_STOPPED, with their bound.
+ */
+template <typename Iterator>
+static void search_finish (SearchRun &run, TSPInfo &tsp_info, Iterator first, Iterator last) {
+	tsp_info.lower_bound = search_lower_bound(tsp_info, first, last);
+
+	if (tsp_info.status == SEARCH_COMPLETE && tsp_info.lower_bound < tsp_info.upper_bound)
+		tsp_info.status = SEARCH_STOPPED;
+
+	// a finished search ends the other searches of its portfolio
+	if (tsp_info.shared && (tsp_info.status == SEARCH_COMPLETE || tsp_info.status == SEARCH_GAP_LIMIT))
+		tsp_info.shared->finished = true;
+
+	search_checkpoint(run, tsp_info, first, last, true);
+	checkpoint_writer_finish(run.writer);
+
+	tsp_info.stats.elapsed = run.elapsed_before + seconds_between(run.start, Clock::now());
+
+	if (run.metrics)
+		metrics_search_end(*run.metrics);
+}
+
+/**
+ * Number of children of `node`, see branching_child_count
+ */
+static size_t search_child_count (TSPInfo &tsp_info, const Node &node) {
+	if (!node.child_bounds.empty())
+		return node.child_bounds.size();
+
+	bool reversible = branching_reversible(node.prohibited_edges.data(),
+		node.prohibited_edges.size());
+
+	return branching_child_count(tsp_info, node.subtours[node.chosen_subtour], reversible);
+}
+
+/**
+ * Whether `node` has children left to create
+ */
+static bool search_children_left (TSPInfo &tsp_info, const Node &node) {
+	return node.next_child < search_child_count(tsp_info, node);
+}
+
+/**
+ * Raises the bound of `node` to the lowest bound of the children it
+ * has left to create, when they are known: the tours left below it
+ * are theirs
+ */
+static void search_raise_bound (Node &node) {
+	if (node.next_child >= node.child_bounds.size())
+		return;
+
+	double lower_bound = node.child_bounds[node.next_child];
+	for (size_t k = node.next_child +1; k < node.child_bounds.size(); ++k) {
+		lower_bound = std::min(lower_bound, node.child_bounds[k]);
+	}
+
+	node.lower_bound = std::max(node.lower_bound, lower_bound);
+}
+
+/**
+ * Creates and evaluates child `node.next_child` of `node` (see
+ * branching_child_edges) into `child`, returns whether it is open
+ *
+ * A child whose bound is above the incumbent, or that is a tour
+ * (which may become the incumbent), is closed. Its later siblings
+ * are still created: the children overlap, and a tour a closed child
+ * can't hold may be in any of them. The bounds of `node` and of an
+ * open child are raised to those of the children they have left,
+ * and the child's to its estimate.
+ */
+static bool search_next_child (SearchRun &run, TSPInfo &tsp_info, Node &node, Node &child) {
+	std::vector<int> &subtour = node.subtours[node.chosen_subtour];
+
+	// bound of the child estimated by `node`, it holds for the tours
+	// below the child and the additive bounding may fall short of it
+	double estimate = node.lower_bound;
+	if (node.next_child < node.child_bounds.size())
+		estimate = node.child_bounds[node.next_child];
+
+	child.prohibited_edges = node.prohibited_edges;
+	branching_child_edges(tsp_info, subtour, node.next_child++, child.prohibited_edges);
+
+	// a child that can't beat the incumbent is solved only
+	// until that is proven
+	node_calculate_solution(child, tsp_info, tsp_info.upper_bound);
+	++tsp_info.stats.generated;
+
+	bool open = true;
+
+	if (child.lower_bound > tsp_info.upper_bound) {
+		// ignore node and all of its childs
+		open = false;
+	} else if (child.cut) {
+		// possible solution: if this solution cost is lower than the
+		// current upper bound then we updated the upper bound and this
+		// solution is marked as best
+		if (child.lower_bound < tsp_info.upper_bound)
+			search_incumbent(run, tsp_info, child);
+
+		open = false;
+	}
+
+	search_raise_bound(node);
+	if (open) {
+		child.lower_bound = std::max(child.lower_bound, estimate);
+		search_raise_bound(child);
+	}
+
+	return open;
+}
+
+/**
+ * Creates and evaluates the children of `node` left to create, and
+ * appends the open ones to `children`
+ *
+ * `node` is patched first when it is due, so that the children are
+ * pruned against the resulting incumbent.
+ */
+static void search_children (SearchRun &run, TSPInfo &tsp_info, Node &node,
+		std::vector<Node> &children) {
+	if (node.next_child == 0 && search_patch_due(run, tsp_info))
+		search_patch(run, tsp_info, node);
+
+	while (search_children_left(tsp_info, node)) {
+		Node child = node_new();
+
+		if (search_next_child(run, tsp_info, node, child))
+			children.push_back(std::move(child));
+		else
+			node_recycle(child);
+	}
+}
+
+/**
+ * Step of the searches that take their nodes from a queue by bound:
+ * `node`, just taken, creates its next child only, into `child`,
+ * and returns whether that child is open
+ *
+ * A child is solved only once the search reaches it, its bound
+ * estimated from the reduced costs of its parent until then (see
+ * branching_child_bounds): children left by a node that can no
+ * longer beat the incumbent are never solved. `node` is counted as
+ * expanded, and patched when due, with its first child.
+ */
+static bool search_lazy_child (SearchRun &run, TSPInfo &tsp_info, Node &node, Node &child) {
+	if (node.next_child == 0) {
+		++tsp_info.stats.expanded;
+
+		if (search_patch_due(run, tsp_info))
+			search_patch(run, tsp_info, node);
+	}
+
+	return search_next_child(run, tsp_info, node, child);
+}
+
+struct s_parallel_worker;
+
+/**
+ * State shared by the threads of a parallel best-bound search
+ */
+typedef struct s_parallel_search {
+	MultiQueue *queue;
+	SearchShared shared;
+
+	/**
+	 * Nodes in the queue or being expanded, the search is over once
+	 * there are none left
+	 */
+	std::atomic<long> pending;
+	std::atomic<long> expanded;
+	long expanded_before;
+
+	/**
+	 * Set, along with `status`, when a limit is reached
+	 */
+	std::atomic<bool> stop;
+	std::atomic<int> status;
+
+	/**
+	 * Bound of the node each thread is expanding (which is in no
+	 * heap meanwhile), infinity when it has none and minus infinity
+	 * while it takes one
+	 */
+	std::vector< std::atomic<double> > expanding;
+
+	Clock::time_point start;
+
+	/**
+	 * Checkpoints, saved by the first thread: the run and instance
+	 * of the whole search, and the threads whose statistics it adds
+	 * up. While `pause` is set the other threads wait at the top of
+	 * their loop, holding no node, and count themselves in `paused`
+	 * out of the `active` threads still in their loop.
+	 */
+	SearchRun *run;
+	TSPInfo *tsp_info;
+	std::vector<struct s_parallel_worker> *workers;
+
+	std::mutex pause_mutex;
+	std::condition_variable pause_changed;
+	std::atomic<bool> pause;
+	int paused;
+	int active;
+} ParallelSearch;
+
+typedef struct s_parallel_worker {
+	ParallelSearch *search;
+	int index;
+	TSPInfo tsp_info;
+	Options options;
+} ParallelWorker;
+
+/**
+ * Lowest bound of the open nodes of a parallel search, some of
+ * which may be being expanded
+ */
+static double parallel_lower_bound (ParallelSearch &ps, double upper_bound) {
+	double lower_bound = ps.queue->lower_bound(upper_bound);
+
+	for (size_t t = 0; t < ps.expanding.size(); ++t) {
+		lower_bound = std::min(lower_bound, ps.expanding[t].load());
+	}
+
+	return lower_bound;
+}
+
+/**
+ * Checks the limits of a parallel search, stopping every thread
+ * once one is reached; the gap is measured by the first thread only
+ */
+static bool parallel_should_stop (ParallelSearch &ps, ParallelWorker &worker, SearchRun &run) {
+	Options &options = worker.options;
+	TSPInfo &tsp_info = worker.tsp_info;
+	int status = -1;
+
+	if (options.node_limit > 0 && ps.expanded - ps.expanded_before >= options.node_limit) {
+		status = SEARCH_NODE_LIMIT;
+	} else if (options.time_limit > 0
+			&& seconds_between(ps.start, Clock::now()) >= options.time_limit) {
+		status = SEARCH_TIME_LIMIT;
+	} else if (worker.index == 0 && options.gap >= 0 && tsp_info.upper_bound < INFINITE
+			&& (run.incumbent_changed || tsp_info.stats.expanded % GAP_CHECK_INTERVAL == 0)) {
+		run.incumbent_changed = false;
+
+		if (search_gap(tsp_info.upper_bound, parallel_lower_bound(ps, tsp_info.upper_bound)) <= options.gap)
+			status = SEARCH_GAP_LIMIT;
+	}
+
+	if (status >= 0 && !ps.stop.exchange(true))
+		ps.status = status;
+
+	return ps.stop;
+}
+
+/**
+ * Waits, holding no node, while the first thread saves a checkpoint
+ */
+static void parallel_wait (ParallelSearch &ps) {
+	std::unique_lock<std::mutex> lock (ps.pause_mutex);
+
+	++ps.paused;
+	ps.pause_changed.notify_all();
+	ps.pause_changed.wait(lock, [&] () { return !ps.pause; });
+	--ps.paused;
+}
+
+/**
+ * Leaves the loop of the threads, a checkpoint no longer waits for
+ * the thread
+ */
+static void parallel_leave (ParallelSearch &ps) {
+	std::lock_guard<std::mutex> lock (ps.pause_mutex);
+
+	--ps.active;
+	ps.pause_changed.notify_all();
+}
+
+/**
+ * Saves a checkpoint from the first thread: the other threads are
+ * paused first, so that every open node is in the queue rather than
+ * being expanded, then the queue is saved and refilled
+ */
+static void parallel_checkpoint (ParallelSearch &ps, uint64_t &seed) {
+	TRACE_SCOPE("checkpoint");
+
+	{
+		std::unique_lock<std::mutex> lock (ps.pause_mutex);
+
+		ps.pause = true;
+		ps.pause_changed.wait(lock, [&] () { return ps.paused == ps.active -1; });
+	}
+
+	// the instance of the whole search holds the shared incumbent
+	// and the statistics of every thread while it is saved
+	TSPInfo &tsp_info = *ps.tsp_info;
+	SearchStats stats = tsp_info.stats;
+
+	for (size_t t = 0; t < ps.workers->size(); ++t) {
+		tsp_info.stats.expanded += (*ps.workers)[t].tsp_info.stats.expanded;
+		tsp_info.stats.generated += (*ps.workers)[t].tsp_info.stats.generated;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (ps.shared.mutex);
+		tsp_info.upper_bound = ps.shared.upper_bound;
+		tsp_info.best_tour = ps.shared.best_tour;
+	}
+
+	std::vector<Node> frontier;
+	ps.queue->drain(frontier);
+	search_checkpoint(*ps.run, tsp_info, frontier.begin(), frontier.end(), true);
+
+	for (size_t k = 0; k < frontier.size(); ++k) {
+		ps.queue->push(std::move(frontier[k]), seed);
+	}
+
+	tsp_info.stats = stats;
+
+	{
+		std::lock_guard<std::mutex> lock (ps.pause_mutex);
+
+		ps.pause = false;
+		ps.pause_changed.notify_all();
+	}
+}
+
+/**
+ * Expands nodes of the shared queue until there are none left or
+ * the search is stopped; a better incumbent prunes the whole queue
+ */
+static void parallel_worker (ParallelWorker *worker) {
+	ParallelSearch &ps = *worker->search;
+	TSPInfo &tsp_info = worker->tsp_info;
+	std::atomic<double> &expanding = ps.expanding[worker->index];
+
+	SearchRun run;
+	run.search = BEST_BOUND_SEARCH;
+	run.options = &worker->options;
+	run.incumbent_changed = false;
+	run.checkpointing = false;
+	run.start = ps.start;
+	run.expanded_before = 0;
+	run.metrics = NULL;
+
+	if (metrics_enabled) {
+		run.metrics = &metrics_thread();
+		metrics_search_begin(*run.metrics, tsp_info.solve);
+	}
+
+	uint64_t seed = 0x9E3779B97F4A7C15ULL * (worker->index +1);
+	Node node;
+
+	while (ps.pending > 0) {
+		if (ps.pause)
+			parallel_wait(ps);
+
+		search_sync(run, tsp_info);
+
+		if (parallel_should_stop(ps, *worker, run))
+			break;
+
+		if (worker->index == 0 && search_checkpoint_due(*ps.run))
+			parallel_checkpoint(ps, seed);
+
+		if (search_metrics_due(run)) {
+			// the first thread speaks for the queue, the bound of a
+			// node being taken is unknown until it is taken
+			if (worker->index == 0) {
+				double lower_bound = parallel_lower_bound(ps, tsp_info.upper_bound);
+				if (lower_bound == -std::numeric_limits<double>::infinity())
+					lower_bound = run.metrics->lower_bound;
+
+				search_publish(run, tsp_info, ps.pending, lower_bound, ps.queue->memory());
+			} else {
+				search_publish(run, tsp_info, 0, -std::numeric_limits<double>::infinity(), 0);
+			}
+		}
+
+		expanding = -std::numeric_limits<double>::infinity();
+
+		if (!ps.queue->pop(node, seed)) {
+			// the other threads are expanding the last nodes
+			expanding = std::numeric_limits<double>::infinity();
+
+			double idle = run.metrics ? metrics_now() : 0;
+			std::this_thread::yield();
+			if (run.metrics)
+				run.metrics->idle = run.metrics->idle + (metrics_now() - idle);
+
+			continue;
+		}
+
+		expanding = node.lower_bound;
+
+		if (node.lower_bound <= tsp_info.upper_bound) {
+			TRACE_SCOPE("expand");
+
+			double incumbent = tsp_info.upper_bound;
+			if (node.next_child == 0)
+				++ps.expanded;
+
+			// creates its next child, both go back to the queue while
+			// open
+			Node child = node_new();
+			if (search_lazy_child(run, tsp_info, node, child)) {
+				++ps.pending;
+				ps.queue->push(std::move(child), seed);
+			} else {
+				node_recycle(child);
+			}
+
+			if (search_children_left(tsp_info, node)) {
+				++ps.pending;
+				ps.queue->push(std::move(node), seed);
+			}
+
+			// bulk deletion of the nodes the new incumbent prunes
+			if (tsp_info.upper_bound < incumbent) {
+				TRACE_SCOPE("prune");
+				ps.pending -= ps.queue->prune(tsp_info.upper_bound);
+			}
+		}
+
+		expanding = std::numeric_limits<double>::infinity();
+		node_recycle(node);
+		--ps.pending;
+	}
+
+	parallel_leave(ps);
+
+	// the first thread's search ends with search_finish()
+	if (run.metrics && worker->index != 0)
+		metrics_search_end(*run.metrics);
+}
+
+/**
+ * Best-bound search on `options.threads` threads sharing a
+ * MultiQueue, each with its own copy of the instance (overlay,
+ * statistics) and a shared incumbent
+ *
+ * The nodes are expanded in nearly, rather than exactly, best-bound
+ * order, so the tree may be a little larger than the sequential
+ * one. Checkpoints pause every thread while the first one saves the
+ * queue (see parallel_checkpoint).
+ */
+static void search_best_parallel (TSPInfo &tsp_info, Options &options, Checkpoint *resume) {
+	SearchRun run;
+	std::vector<Node> seed;
+	search_start(run, tsp_info, options, BEST_BOUND_SEARCH, resume, seed);
+
+	int threads = options.threads;
+	MultiQueue queue (threads * PARALLEL_QUEUES_PER_THREAD);
+
+	ParallelSearch ps;
+	ps.queue = &queue;
+	ps.shared.upper_bound = tsp_info.upper_bound;
+	ps.shared.best_tour = tsp_info.best_tour;
+	ps.shared.finished = false;
+	ps.pending = seed.size();
+	ps.expanded = tsp_info.stats.expanded;
+	ps.expanded_before = tsp_info.stats.expanded;
+	ps.stop = false;
+	ps.status = SEARCH_COMPLETE;
+	ps.expanding = std::vector< std::atomic<double> > (threads);
+	ps.start = run.start;
+	ps.run = &run;
+	ps.tsp_info = &tsp_info;
+	ps.pause = false;
+	ps.paused = 0;
+	ps.active = threads;
+
+	uint64_t push_seed = 1;
+	for (size_t k = 0; k < seed.size(); ++k) {
+		queue.push(std::move(seed[k]), push_seed);
+	}
+
+	tsp_prepare(tsp_info);
+	std::vector<ParallelWorker> workers (threads);
+	ps.workers = &workers;
+
+	for (int t = 0; t < threads; ++t) {
+		ParallelWorker &worker = workers[t];
+
+		worker.search = &ps;
+		worker.index = t;
+		worker.tsp_info = tsp_info;
+		worker.tsp_info.shared = &ps.shared;
+		worker.tsp_info.stats = SearchStats();
+		// the checkpoints are saved by the first thread for all
+		worker.options = options;
+		worker.options.checkpoint_path.clear();
+
+		ps.expanding[t] = std::numeric_limits<double>::infinity();
+	}
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; ++t) {
+		pool.push_back(std::thread(parallel_worker, &workers[t]));
+	}
+
+	parallel_worker(&workers[0]);
+
+	for (size_t t = 0; t < pool.size(); ++t) {
+		pool[t].join();
+	}
+
+	tsp_info.upper_bound = ps.shared.upper_bound;
+	tsp_info.best_tour = ps.shared.best_tour;
+	tsp_info.status = ps.status;
+
+	for (int t = 0; t < threads; ++t) {
+		tsp_info.stats.expanded += workers[t].tsp_info.stats.expanded;
+		tsp_info.stats.generated += workers[t].tsp_info.stats.generated;
+	}
+
+	std::vector<Node> frontier;
+	queue.drain(frontier);
+	search_finish(run, tsp_info, frontier.begin(), frontier.end());
+}
+
+void search_best (TSPInfo &tsp_info, Options &options, Checkpoint *resume) {
+	// searches of a portfolio already run on their own thread
+	if (options.threads > 1 && !tsp_info.shared) {
+		search_best_parallel(tsp_info, options, resume);
+		return;
+	}
+
+	SearchRun run;
+	std::vector<Node> seed;
+	search_start(run, tsp_info, options, BEST_BOUND_SEARCH, resume, seed);
+
+	NodeQueue tree;
+	for (size_t k = 0; k < seed.size(); ++k) {
+		tree.push(std::move(seed[k]));
+	}
+
+	while (tree.size()) {
+		if (search_should_stop(run, tsp_info, [&] () { return tree.top().lower_bound; }))
+			break;
+
+		TRACE_SCOPE("expand");
+
+		Node curr_node = tree.pop();
+
+		// the incumbent improved since it was pushed
+		if (curr_node.lower_bound > tsp_info.upper_bound) {
+			node_recycle(curr_node);
+			continue;
+		}
+
+		// creates its next child, both go back to the tree while open
+		Node child = node_new();
+		if (search_lazy_child(run, tsp_info, curr_node, child))
+			tree.push(std::move(child));
+		else
+			node_recycle(child);
+
+		if (search_children_left(tsp_info, curr_node))
+			tree.push(std::move(curr_node));
+		else
+			node_recycle(curr_node);
+
+		if (search_metrics_due(run))
+			search_publish(run, tsp_info, tree.nodes().begin(), tree.nodes().end());
+
+		search_checkpoint(run, tsp_info, tree.nodes().begin(), tree.nodes().end(), false);
+	}
+
+	search_finish(run, tsp_info, tree.nodes().begin(), tree.nodes().end());
+}
+
+void search_breadth (TSPInfo &tsp_info, Options &options, Checkpoint *resume) {
+	SearchRun run;
+	std::vector<Node> seed;
+	search_start(run, tsp_info, options, BREADTH_FIRST_SEARCH, resume, seed);
+
+	NodeFifo tree;
+	for (size_t k = 0; k < seed.size(); ++k) {
+		tree.push(std::move(seed[k]));
+	}
+
+	std::vector<Node> children;
+
+	while (tree.size()) {
+		if (search_should_stop(run, tsp_info, [&] () {
+				return search_lower_bound(tsp_info, tree.begin(), tree.end()); }))
+			break;
+
+		TRACE_SCOPE("expand");
+
+		Node curr_node = tree.pop();
+		++tsp_info.stats.expanded;
+
+		// creates and pushes children to tree
+		children.clear();
+		search_children(run, tsp_info, curr_node, children);
+
+		for (size_t k = 0; k < children.size(); ++k) {
+			TRACE_SCOPE("push");
+			tree.push(std::move(children[k]));
+		}
+
+		node_recycle(curr_node);
+
+		if (search_metrics_due(run))
+			search_publish(run, tsp_info, tree.begin(), tree.end());
+
+		search_checkpoint(run, tsp_info, tree.begin(), tree.end(), false);
+	}
+
+	search_finish(run, tsp_info, tree.begin(), tree.end());
+}
+
+/**
+ * Schedule of the dives of search_hybrid
+ */
+typedef struct s_dive_schedule {
+	/**
+	 * Best-first expansions between two dives
+	 */
+	long frequency;
+	long min_frequency;
+	long max_frequency;
+
+	/**
+	 * Levels a dive may go down, 0 for no limit
+	 */
+	long depth;
+
+	long since_dive;
+} DiveSchedule;
+
+/**
+ * Adapts the schedule to the outcome of a dive: dives that improve
+ * the incumbent are made more frequent, the others less frequent
+ * and, when they were stopped by the depth limit, deeper
+ */
+static void search_dive_adapt (DiveSchedule &dive, bool improved, bool limited) {
+	if (improved) {
+		dive.frequency = std::max(dive.min_frequency, dive.frequency / 2);
+		return;
+	}
+
+	dive.frequency = std::min(dive.max_frequency, dive.frequency * 2);
+
+	if (limited)
+		dive.depth += dive.depth / 2 +1;
+}
+
+/**
+ * Dives depth first from `node`: at each level the child of lowest
+ * bound is followed and its open siblings go to `tree`, until the
+ * path is closed (pruned, or ended by a tour) or the depth limit
+ * is reached, in which case the last node goes back to `tree`
+ *
+ * A dive that found no better tour patches the last node it
+ * reached, which is nearly a tour.
+ */
+static void search_dive (SearchRun &run, TSPInfo &tsp_info, DiveSchedule &dive,
+		NodeQueue &tree, Node &node, std::vector<Node> &children) {
+	TRACE_SCOPE("dive");
+
+	double incumbent = tsp_info.upper_bound;
+	bool limited = false;
+	long level = 0;
+
+	while (true) {
+		children.clear();
+		search_children(run, tsp_info, node, children);
+
+		if (children.empty()) {
+			if (tsp_info.upper_bound >= incumbent && run.options->patch_interval > 0)
+				search_patch(run, tsp_info, node);
+
+			node_recycle(node);
+			break;
+		}
+
+		node_recycle(node);
+
+		size_t best = 0;
+		for (size_t k = 1; k < children.size(); ++k) {
+			if (children[k].lower_bound < children[best].lower_bound)
+				best = k;
+		}
+
+		for (size_t k = 0; k < children.size(); ++k) {
+			if (k != best)
+				tree.push(std::move(children[k]));
+		}
+
+		node = std::move(children[best]);
+
+		if (dive.depth > 0 && ++level >= dive.depth) {
+			limited = true;
+			if (tsp_info.upper_bound >= incumbent && run.options->patch_interval > 0)
+				search_patch(run, tsp_info, node);
+
+			tree.push(std::move(node));
+			break;
+		}
+
+		if (search_should_stop(run, tsp_info, [&] () {
+				return std::min(node.lower_bound, tree.size() ? tree.top().lower_bound : node.lower_bound); })) {
+			tree.push(std::move(node));
+			break;
+		}
+
+		++tsp_info.stats.expanded;
+	}
+
+	search_dive_adapt(dive, tsp_info.upper_bound < incumbent, limited);
+}
+
+void search_hybrid (TSPInfo &tsp_info, Options &options, Checkpoint *resume) {
+	SearchRun run;
+	std::vector<Node> seed;
+	search_start(run, tsp_info, options, HYBRID_SEARCH, resume, seed);
+
+	NodeQueue tree;
+	for (size_t k = 0; k < seed.size(); ++k) {
+		tree.push(std::move(seed[k]));
+	}
+
+	DiveSchedule dive;
+	dive.frequency = options.dive_frequency;
+	dive.min_frequency = std::max(1L, options.dive_frequency / DIVE_FREQUENCY_RANGE);
+	dive.max_frequency = options.dive_frequency * DIVE_FREQUENCY_RANGE;
+	dive.depth = options.dive_depth;
+	dive.since_dive = 0;
+
+	std::vector<Node> children;
+
+	while (tree.size()) {
+		if (search_should_stop(run, tsp_info, [&] () { return tree.top().lower_bound; }))
+			break;
+
+		TRACE_SCOPE("expand");
+
+		Node curr_node = tree.pop();
+
+		// the incumbent improved since it was pushed
+		if (curr_node.lower_bound > tsp_info.upper_bound) {
+			node_recycle(curr_node);
+			continue;
+		}
+
+		bool expanding = curr_node.next_child == 0;
+
+		// dives look for a first incumbent right away, and for better
+		// ones every dive.frequency expansions
+		if (tsp_info.upper_bound >= INFINITE || (expanding && ++dive.since_dive >= dive.frequency)) {
+			if (expanding)
+				++tsp_info.stats.expanded;
+
+			dive.since_dive = 0;
+			search_dive(run, tsp_info, dive, tree, curr_node, children);
+		} else {
+			// creates its next child, both go back to the tree while open
+			Node child = node_new();
+			if (search_lazy_child(run, tsp_info, curr_node, child))
+				tree.push(std::move(child));
+			else
+				node_recycle(child);
+
+			if (search_children_left(tsp_info, curr_node))
+				tree.push(std::move(curr_node));
+			else
+				node_recycle(curr_node);
+		}
+
+		if (search_metrics_due(run))
+			search_publish(run, tsp_info, tree.nodes().begin(), tree.nodes().end());
+
+		search_checkpoint(run, tsp_info, tree.nodes().begin(), tree.nodes().end(), false);
+	}
+
+	search_finish(run, tsp_info, tree.nodes().begin(), tree.nodes().end());
+}
+
+/**
+ * Level of the depth first search: a node being branched, the
+ * assignment it was solved with and the next of its children
+ */
+typedef struct s_depth_frame {
+	Node node;
+
+	/**
+	 * Solver state of `node`, copied into each child before it is
+	 * re-optimized, so backtracking needs no undoing of its own
+	 */
+	Assignment assignment;
+
+	/**
+	 * Child to create next: the one prohibiting the edge between
+	 * cities `next` and `next + 1` of the chosen subtour, out of
+	 * `children` (see branching_child_count)
+	 */
+	size_t next;
+	size_t children;
+
+	/**
+	 * The prohibited edges of `node` are the first `prohibited` of
+	 * the path, `base` of them were already prohibited in its parent
+	 */
+	size_t base;
+	size_t prohibited;
+} DepthFrame;
+
+/**
+ * State of search_depth: only the current path is kept, each level
+ * prohibits one edge (one or both of its arcs) more than the level
+ * above
+ */
+typedef struct s_depth_search {
+	/**
+	 * Levels [0, depth) of the path, deeper ones are kept for their
+	 * memory
+	 */
+	std::vector<DepthFrame> path;
+	size_t depth;
+
+	/**
+	 * Edges prohibited along the path, the undo log of
+	 * tsp_info.cost_overlay: both always have the same size
+	 */
+	std::vector< std::pair<int, int> > prohibited;
+
+	/**
+	 * Arcs prohibited by the child being created
+	 */
+	std::vector< std::pair<int, int> > child_edges;
+
+	std::vector<int> successor;
+
+	/**
+	 * Reduced costs handed to the additive bounding
+	 */
+	std::vector<int> reduced_cost;
+	std::vector<int *> reduced_rows;
+} DepthSearch;
+
+static void depth_prohibit (DepthSearch &dfs, TSPInfo &tsp_info, std::pair<int, int> edge) {
+	dfs.prohibited.push_back(edge);
+	tsp_info.cost_overlay.set(edge.first -1, edge.second -1, INFINITE);
+}
+
+/**
+ * Undoes the latest prohibitions until `size` are left
+ */
+static void depth_undo (DepthSearch &dfs, TSPInfo &tsp_info, size_t size) {
+	while (dfs.prohibited.size() > size) {
+		dfs.prohibited.pop_back();
+		tsp_info.cost_overlay.pop();
+	}
+}
+
+/**
+ * Opens a new level at the bottom of the path
+ */
+static DepthFrame &depth_push (DepthSearch &dfs) {
+	if (dfs.path.size() == dfs.depth)
+		dfs.path.emplace_back();
+
+	DepthFrame &frame = dfs.path[dfs.depth++];
+	node_recycle(frame.node);
+	frame.node = node_new();
+	frame.next = 0;
+
+	return frame;
+}
+
+/**
+ * Closes the bottom level of the path, undoing its prohibitions
+ */
+static void depth_pop (DepthSearch &dfs, TSPInfo &tsp_info) {
+	DepthFrame &frame = dfs.path[--dfs.depth];
+	depth_undo(dfs, tsp_info, frame.base);
+}
+
+/**
+ * Sets the bound and subtours of the node of `frame` from its
+ * assignment
+ */
+static void depth_evaluate (DepthSearch &dfs, TSPInfo &tsp_info, DepthFrame &frame) {
+	int **reduced_cost = NULL;
+
+	if (tsp_info.bounding == BOUNDING_ADDITIVE
+			|| branching_needs_reduced_costs(tsp_info.branching)) {
+		TRACE_SCOPE("reduced_costs");
+		size_t n = tsp_info.dimension;
+
+		dfs.reduced_cost.resize(n * n);
+		dfs.reduced_rows.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			dfs.reduced_rows[i] = &dfs.reduced_cost[i * n];
+		}
+
+		assignment_reduced_costs(frame.assignment, node_cost_row, &tsp_info,
+			dfs.reduced_rows.data());
+		reduced_cost = dfs.reduced_rows.data();
+	}
+
+	assignment_successors(frame.assignment, dfs.successor);
+	node_set_solution(frame.node, tsp_info, frame.assignment.cost,
+		dfs.successor.data(), reduced_cost);
+
+	bool reversible = branching_reversible(dfs.prohibited.data(), frame.prohibited);
+	frame.children = branching_child_count(tsp_info,
+		frame.node.subtours[frame.node.chosen_subtour], reversible);
+}
+
+/**
+ * Closes the node at the bottom of the path if it can't lead to a
+ * better tour than the incumbent, or is a tour itself (which may
+ * become the incumbent)
+ */
+static void depth_close (SearchRun &run, DepthSearch &dfs, TSPInfo &tsp_info) {
+	Node &node = dfs.path[dfs.depth -1].node;
+
+	if (node.lower_bound > tsp_info.upper_bound) {
+		// ignore node and all of its childs
+		depth_pop(dfs, tsp_info);
+		return;
+	}
+
+	// possible solution
+	if (node.cut) {
+		// if this solution cost is lower than the current upper bound
+		// then we updated the upper bound and this solution is marked as best
+		if (node.lower_bound < tsp_info.upper_bound)
+			search_incumbent(run, tsp_info, node);
+
+		depth_pop(dfs, tsp_info);
+	}
+}
+
+/**
+ * Starts a new path from `seed`: its assignment is solved from
+ * scratch with all of its prohibited edges
+ */
+static void depth_seed (SearchRun &run, DepthSearch &dfs, TSPInfo &tsp_info, const Node &seed) {
+	depth_undo(dfs, tsp_info, 0);
+	for (size_t k = 0; k < seed.prohibited_edges.size(); ++k) {
+		depth_prohibit(dfs, tsp_info, seed.prohibited_edges[k]);
+	}
+
+	DepthFrame &frame = depth_push(dfs);
+	frame.base = 0;
+	frame.prohibited = dfs.prohibited.size();
+
+	{
+		MetricsSolveScope timer (METRICS_ASSIGNMENT);
+		assignment_solve(frame.assignment, tsp_info.dimension, node_cost_row, &tsp_info);
+	}
+	depth_evaluate(dfs, tsp_info, frame);
+
+	// children a checkpoint saved before they were evaluated carry
+	// no subtour, the root and the other saved nodes were counted
+	// when generated
+	if (seed.subtours.empty() || seed.subtours[seed.chosen_subtour].empty())
+		++tsp_info.stats.generated;
+
+	depth_close(run, dfs, tsp_info);
+}
+
+/**
+ * Lowest bound among the children not created yet, whose bound is
+ * the one of their parent, and the seeds not started yet
+ */
+static double depth_lower_bound (DepthSearch &dfs, TSPInfo &tsp_info,
+		std::vector<Node> &seed, size_t next_seed) {
+	double lower_bound = search_lower_bound(tsp_info, seed.begin() + next_seed, seed.end());
+
+	for (size_t d = 0; d < dfs.depth; ++d) {
+		DepthFrame &frame = dfs.path[d];
+
+		if (frame.next < frame.children && frame.node.lower_bound < lower_bound)
+			lower_bound = frame.node.lower_bound;
+	}
+
+	return lower_bound;
+}
+
+/**
+ * Open nodes in the order the search would take them: the children
+ * not created yet, from the bottom of the path up, then the seeds
+ * not started yet
+ *
+ * The children have no subtour, and the bound of their parent.
+ */
+static void depth_frontier (DepthSearch &dfs, TSPInfo &tsp_info,
+		std::vector<Node> &seed, size_t next_seed, std::vector<Node> &frontier) {
+	frontier.clear();
+
+	for (size_t d = dfs.depth; d > 0; --d) {
+		DepthFrame &frame = dfs.path[d -1];
+		std::vector<int> &subtour = frame.node.subtours[frame.node.chosen_subtour];
+
+		for (size_t i = frame.next; i < frame.children; ++i) {
+			Node child;
+			child.prohibited_edges.assign(dfs.prohibited.begin(),
+				dfs.prohibited.begin() + frame.prohibited);
+			branching_child_edges(tsp_info, subtour, i, child.prohibited_edges);
+			child.lower_bound = frame.node.lower_bound;
+			child.subtours.resize(1);
+			child.chosen_subtour = 0;
+			child.cut = false;
+			child.next_child = 0;
+
+			frontier.push_back(std::move(child));
+		}
+	}
+
+	for (size_t k = next_seed; k < seed.size(); ++k) {
+		frontier.push_back(seed[k]);
+	}
+}
+
+/**
+ * Depth first search that keeps only the current path: going down
+ * prohibits one edge, through the cost overlay, and re-optimizes the
+ * parent's assignment for it; going up pops the overlay entry
+ *
+ * Memory grows with the depth instead of with the frontier, and a
+ * child costs one augmentation of the assignment instead of a full
+ * solve of a copy of the costs.
+ */
+void search_depth (TSPInfo &tsp_info, Options &options, Checkpoint *resume) {
+	SearchRun run;
+	std::vector<Node> seed;
+	search_start(run, tsp_info, options, DEPTH_FIRST_SEARCH, resume, seed);
+
+	DepthSearch dfs;
+	dfs.depth = 0;
+	size_t next_seed = 0;
+
+	std::vector<Node> frontier;
+
+	while (dfs.depth || next_seed < seed.size()) {
+		if (search_should_stop(run, tsp_info, [&] () {
+				return depth_lower_bound(dfs, tsp_info, seed, next_seed); }))
+			break;
+
+		if (!dfs.depth) {
+			depth_seed(run, dfs, tsp_info, seed[next_seed++]);
+			continue;
+		}
+
+		DepthFrame &frame = dfs.path[dfs.depth -1];
+		std::vector<int> &subtour = frame.node.subtours[frame.node.chosen_subtour];
+
+		// every child was created: backtrack
+		if (frame.next >= frame.children) {
+			depth_pop(dfs, tsp_info);
+			continue;
+		}
+
+		TRACE_SCOPE("child");
+
+		if (frame.next == 0) {
+			++tsp_info.stats.expanded;
+
+			if (search_patch_due(run, tsp_info))
+				search_patch(run, tsp_info, frame.node);
+		}
+
+		// edge between nodes next and next+1
+		dfs.child_edges.clear();
+		branching_child_edges(tsp_info, subtour, frame.next, dfs.child_edges);
+		++frame.next;
+
+		size_t base = dfs.prohibited.size();
+		for (size_t k = 0; k < dfs.child_edges.size(); ++k) {
+			depth_prohibit(dfs, tsp_info, dfs.child_edges[k]);
+		}
+
+		// `frame` may move when the path grows
+		DepthFrame &child = depth_push(dfs);
+		DepthFrame &parent = dfs.path[dfs.depth -2];
+		child.base = base;
+		child.prohibited = dfs.prohibited.size();
+		child.assignment = parent.assignment;
+
+		// only the arc of the subtour is assigned, raising the cost
+		// of its reverse keeps the assignment optimal
+		{
+			TRACE_SCOPE("reoptimize");
+			MetricsSolveScope timer (METRICS_ASSIGNMENT);
+			assignment_reoptimize(child.assignment, dfs.child_edges[0].first -1,
+				dfs.child_edges[0].second -1, node_cost_row, &tsp_info);
+		}
+
+		depth_evaluate(dfs, tsp_info, child);
+		++tsp_info.stats.generated;
+
+		depth_close(run, dfs, tsp_info);
+
+		bool checkpoint_due = search_checkpoint_due(run);
+		bool metrics_due = search_metrics_due(run);
+
+		if (checkpoint_due || metrics_due) {
+			depth_frontier(dfs, tsp_info, seed, next_seed, frontier);
+
+			if (metrics_due)
+				search_publish(run, tsp_info, frontier.begin(), frontier.end());
+			if (checkpoint_due)
+				search_checkpoint(run, tsp_info, frontier.begin(), frontier.end(), true);
+		}
+	}
+
+	depth_frontier(dfs, tsp_info, seed, next_seed, frontier);
+	search_finish(run, tsp_info, frontier.begin(), frontier.end());
+
+	depth_undo(dfs, tsp_info, 0);
+}
+
+/**
+ * Solves an instance of at most `exact_max` cities by dynamic
+ * programming (see held_karp.h) instead of searching it, returns
+ * false when the instance is larger or the table doesn't fit in
+ * memory
+ */
+static bool search_exact (TSPInfo &tsp_info, Options &options) {
+	size_t memory = held_karp_memory(tsp_info.dimension);
+
+	if (tsp_info.dimension < 2 || tsp_info.dimension > options.exact_max || !memory)
+		return false;
+
+	size_t limit = held_karp_memory_limit();
+
+	if (memory > limit) {
+		if (!options.quiet)
+			std::cout << "Dynamic programming needs " << (memory >> 20) << " MB, above the "
+				<< (limit >> 20) << " MB it may take: searching instead" << std::endl;
+		return false;
+	}
+
+	TRACE_SCOPE("held_karp");
+
+	Clock::time_point start = Clock::now();
+	std::vector<int> tour;
+	double cost;
+
+	try {
+		cost = held_karp_solve(tsp_info.dimension, node_cost_row, &tsp_info,
+			options_helper_threads(options), tour);
+	} catch (const std::bad_alloc &) {
+		return false;
+	}
+
+	tsp_info.stats = SearchStats();
+	tsp_info.stats.elapsed = seconds_between(start, Clock::now());
+	tsp_info.status = SEARCH_COMPLETE;
+
+	if (cost < tsp_info.upper_bound) {
+		tsp_info.upper_bound = cost;
+		tsp_info.best_tour = tour;
+	}
+	tsp_info.lower_bound = tsp_info.upper_bound;
+
+	if (!options.quiet)
+		std::cout << "Solved by dynamic programming in "
+			<< tsp_info.stats.elapsed << " seconds" << std::endl;
+
+	return true;
+}
+
+void search_run (int search, TSPInfo &tsp_info, Options &options, Checkpoint *resume) {
+	if (!resume && search_exact(tsp_info, options))
+		return;
+
+	switch (search) {
+	case BEST_BOUND_SEARCH:
+		search_best(tsp_info, options, resume);
+		break;
+	case BREADTH_FIRST_SEARCH:
+		search_breadth(tsp_info, options, resume);
+		break;
+	case DEPTH_FIRST_SEARCH:
+		search_depth(tsp_info, options, resume);
+		break;
+	case HYBRID_SEARCH:
+		search_hybrid(tsp_info, options, resume);
+		break;
+	case PORTFOLIO_SEARCH:
+		search_portfolio(tsp_info, options);
+		break;
+	case AUTO_SEARCH:
+		search_autotune(tsp_info, options);
+		break;
+	}
+}
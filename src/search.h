@@ -0,0 +1,103 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <vector> // vector
+#include <mutex> // mutex
+#include <atomic> // atomic
+#include "tsp.h"
+#include "options.h"
+#include "checkpoint.h"
+
+#define BEST_BOUND_SEARCH 1
+#define BREADTH_FIRST_SEARCH 2
+#define DEPTH_FIRST_SEARCH 3
+#define HYBRID_SEARCH 4
+#define PORTFOLIO_SEARCH 5
+#define AUTO_SEARCH 6
+
+// why a search returned, see TSPInfo::status
+#define SEARCH_COMPLETE 0
+#define SEARCH_TIME_LIMIT 1
+#define SEARCH_NODE_LIMIT 2
+#define SEARCH_GAP_LIMIT 3
+#define SEARCH_STOPPED 4
+
+/**
+ * Name of a status code, as the server and the autotuner log it
+ * ("optimal" for SEARCH_COMPLETE)
+ */
+const char *search_status_name (int status);
+
+/**
+ * Incumbent shared by searches running at once on the same instance
+ * (see search_portfolio): each one publishes the tours it finds and
+ * picks up those of the others to prune with, and the first one to
+ * finish (its proof, or reaching the gap) stops the others, which
+ * return with SEARCH_STOPPED. A search proves only once it created
+ * every child and left no open node (see search_finish), so one
+ * member can't cut off the others with a partial tree.
+ *
+ * `upper_bound` and `best_tour` are written under `mutex`, the bound
+ * is also read without it.
+ */
+typedef struct s_search_shared {
+	std::mutex mutex;
+	std::atomic<double> upper_bound;
+	std::vector<int> best_tour;
+
+	std::atomic<bool> finished;
+} SearchShared;
+
+/**
+ * Tree traversals, each one starts from the root of the tree or,
+ * when `resume` is not NULL, from the frontier saved in it
+ *
+ * search_best runs on `options.threads` threads, which take their
+ * nodes from a relaxed concurrent priority queue (see multiqueue.h).
+ */
+void search_best (TSPInfo &tsp_info, Options &options, Checkpoint *resume);
+void search_breadth (TSPInfo &tsp_info, Options &options, Checkpoint *resume);
+void search_depth (TSPInfo &tsp_info, Options &options, Checkpoint *resume);
+
+/**
+ * Best-bound search that periodically dives depth first from the
+ * best open node, to find incumbents early (see --dive-frequency
+ * and --dive-depth)
+ */
+void search_hybrid (TSPInfo &tsp_info, Options &options, Checkpoint *resume);
+
+/**
+ * Runs the strategies of `options.portfolio` (or a default list
+ * sized to the machine) on their own threads, sharing their
+ * incumbent, until one of them finishes; `tsp_info` gets the best
+ * tour and the best of their bounds
+ */
+void search_portfolio (TSPInfo &tsp_info, Options &options);
+
+/**
+ * Autotuning search: the features of the instance (see autotune.h)
+ * order a list of candidate strategies, the first few are probed for
+ * `options.probe_time` seconds each, and the search commits to the
+ * one that finished first or else left the smallest gap, starting
+ * from the best tour the probes found
+ *
+ * With `options.autotune_log` set, the features, the probes, the
+ * choice and the result are appended to that file as a JSON line,
+ * to refine the ordering of the candidates from.
+ */
+void search_autotune (TSPInfo &tsp_info, Options &options);
+
+/**
+ * Runs the traversal `search` (one of the *_SEARCH ids), or solves
+ * the instance by dynamic programming when it has at most
+ * `options.exact_max` cities and the search isn't resumed
+ */
+void search_run (int search, TSPInfo &tsp_info, Options &options, Checkpoint *resume);
+
+/**
+ * Relative gap between an incumbent cost and a lower bound,
+ * infinite while there is no incumbent
+ */
+double search_gap (double upper_bound, double lower_bound);
+
+#endif
@@ -0,0 +1,676 @@
+#include <iostream>
+#include <sstream> // ostringstream
+#include <string> // string
+#include <vector> // vector
+#include <deque> // deque
+#include <map> // map
+#include <set> // set
+#include <memory> // shared_ptr
+#include <thread> // thread
+#include <mutex> // mutex
+#include <condition_variable> // condition_variable
+#include <utility> // move
+#include <algorithm> // max
+#include <cmath> // floor, isfinite
+#include <cstdlib> // EXIT_SUCCESS
+#include <cstring> // strerror
+#include <cerrno> // errno
+#include <csignal> // signal
+#include <unistd.h> // read, write, close, unlink
+#include <sys/stat.h> // stat
+#include <sys/socket.h> // socket, bind, listen, accept, shutdown
+#include <sys/un.h> // sockaddr_un
+#include "server.h"
+#include "json.h"
+#include "tsp.h"
+#include "search.h"
+#include "cache.h"
+#include "data.h" // INFINITE
+#include "metrics.h" // metrics_new_solve
+#include "held_karp.h" // HELD_KARP_MAX
+
+// requests read but not yet taken by a worker, per worker: readers
+// wait beyond it, so a long stream isn't read into memory at once
+#define SERVER_QUEUE_PER_WORKER 4
+
+// instance files kept parsed, the least recently used one is dropped
+#define SERVER_CACHED_INSTANCES 64
+
+// longest request line, a connection sending a longer one is closed
+#define SERVER_MAX_LINE (256 << 20)
+
+/**
+ * Stream the responses to a connection's requests are written to,
+ * shared by the jobs of the connection: closed with the last one
+ */
+typedef struct s_server_connection {
+	int in;
+	int out;
+	bool owned;
+
+	std::mutex mutex;
+
+	~s_server_connection () {
+		if (owned)
+			close(in);
+	}
+} ServerConnection;
+
+typedef struct s_server_job {
+	JsonValue request;
+	std::shared_ptr<ServerConnection> connection;
+} ServerJob;
+
+/**
+ * Parsed instance file, `modified` and `size` tell whether the file
+ * changed since
+ */
+typedef struct s_server_instance {
+	std::shared_ptr<const TSPInfo> tsp_info;
+	time_t modified;
+	off_t size;
+	long last_used;
+} ServerInstance;
+
+typedef struct s_server {
+	Options *options;
+
+	/**
+	 * Helper threads of each request (see options_helper_threads),
+	 * the cores are shared among the workers
+	 */
+	int helper_threads;
+
+	std::mutex mutex;
+	std::condition_variable job_ready;
+	std::condition_variable job_taken;
+	std::deque<ServerJob> jobs;
+	size_t queue_limit;
+
+	/**
+	 * Set once no request will be queued anymore, the workers leave
+	 * when the queue is empty
+	 */
+	bool closed;
+
+	/**
+	 * Set by a shutdown request: the listener and the connections
+	 * stop reading
+	 */
+	bool stopping;
+	int listener;
+	std::set<int> connections;
+
+	/**
+	 * Connection readers still running, the queue is only closed
+	 * once they are all done
+	 */
+	int readers;
+	std::condition_variable readers_done;
+
+	std::mutex cache_mutex;
+	std::map<std::string, ServerInstance> instances;
+	long cache_clock;
+} Server;
+
+static void server_write (ServerConnection &connection, const std::string &text) {
+	std::lock_guard<std::mutex> lock (connection.mutex);
+
+	size_t written = 0;
+	while (written < text.size()) {
+		ssize_t count = write(connection.out, text.data() + written, text.size() - written);
+
+		if (count < 0 && errno == EINTR)
+			continue;
+
+		// the client went away, its remaining results are dropped
+		if (count <= 0)
+			return;
+
+		written += count;
+	}
+}
+
+static std::string server_error (const JsonValue *id, const std::string &message) {
+	std::ostringstream out;
+
+	out << "{\"id\":";
+	json_write(out, id ? *id : JsonValue());
+	out << ",\"status\":\"error\",\"error\":";
+	json_write_string(out, message);
+	out << "}\n";
+
+	return out.str();
+}
+
+/**
+ * Stops reading requests: wakes the accept loop and ends the
+ * reads of every connection
+ */
+static void server_stop (Server &server) {
+	std::lock_guard<std::mutex> lock (server.mutex);
+
+	if (server.stopping)
+		return;
+
+	server.stopping = true;
+
+	if (server.listener >= 0)
+		shutdown(server.listener, SHUT_RDWR);
+
+	for (std::set<int>::iterator it = server.connections.begin();
+			it != server.connections.end(); ++it) {
+		shutdown(*it, SHUT_RD);
+	}
+}
+
+/**
+ * Parsed instance file at `path`, loaded unless a copy of the
+ * current file is cached, NULL with a message in `error` when it
+ * can't be read
+ */
+static std::shared_ptr<const TSPInfo> server_instance (Server &server,
+		const std::string &path, std::string &error) {
+	struct stat status;
+
+	if (stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode)) {
+		error = "Could not open instance " + path;
+		return NULL;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (server.cache_mutex);
+		std::map<std::string, ServerInstance>::iterator it = server.instances.find(path);
+
+		if (it != server.instances.end() && it->second.modified == status.st_mtime
+				&& it->second.size == status.st_size) {
+			it->second.last_used = ++server.cache_clock;
+			return it->second.tsp_info;
+		}
+	}
+
+	// parsed outside of the lock, so that other instances can be
+	// served meanwhile
+	std::shared_ptr<TSPInfo> tsp_info (new TSPInfo());
+	if (!tsp_load(*tsp_info, path, server.helper_threads, error))
+		return NULL;
+
+	tsp_prepare(*tsp_info);
+
+	if (tsp_info->dimension < 2) {
+		error = "Instance " + path + " has fewer than 2 cities";
+		return NULL;
+	}
+
+	std::lock_guard<std::mutex> lock (server.cache_mutex);
+
+	if (server.instances.size() >= SERVER_CACHED_INSTANCES && !server.instances.count(path)) {
+		std::map<std::string, ServerInstance>::iterator oldest = server.instances.begin();
+
+		for (std::map<std::string, ServerInstance>::iterator it = server.instances.begin();
+				it != server.instances.end(); ++it) {
+			if (it->second.last_used < oldest->second.last_used)
+				oldest = it;
+		}
+
+		server.instances.erase(oldest);
+	}
+
+	ServerInstance &instance = server.instances[path];
+	instance.tsp_info = tsp_info;
+	instance.modified = status.st_mtime;
+	instance.size = status.st_size;
+	instance.last_used = ++server.cache_clock;
+
+	return tsp_info;
+}
+
+/**
+ * Builds the instance of an inline "matrix", false with a message
+ * in `error` when it isn't a square matrix of integer costs
+ */
+static bool server_matrix (const JsonValue &matrix, TSPInfo &tsp_info, std::string &error) {
+	int dimension = matrix.items.size();
+
+	if (matrix.type != JSON_ARRAY || dimension < 2) {
+		error = "\"matrix\" must be an array of at least 2 rows";
+		return false;
+	}
+
+	CostMatrix cost_matrix;
+	cost_matrix.resize(dimension, false);
+
+	for (int i = 0; i < dimension; ++i) {
+		const JsonValue &row = matrix.items[i];
+
+		if (row.type != JSON_ARRAY || (int) row.items.size() != dimension) {
+			error = "\"matrix\" row " + std::to_string(i) + " must have "
+				+ std::to_string(dimension) + " entries";
+			return false;
+		}
+
+		for (int j = 0; j < dimension; ++j) {
+			const JsonValue &entry = row.items[j];
+			double cost = INFINITE;
+
+			if (entry.type == JSON_NUMBER) {
+				cost = entry.number;
+
+				if (!std::isfinite(cost) || cost != std::floor(cost) || cost < 0 || cost >= INFINITE) {
+					error = "\"matrix\" entries must be integers in [0, "
+						+ std::to_string(INFINITE) + ")";
+					return false;
+				}
+			} else if (entry.type != JSON_NULL) {
+				error = "\"matrix\" entries must be numbers or null";
+				return false;
+			}
+
+			cost_matrix.set(i, j, cost);
+		}
+	}
+
+	tsp_init_matrix(tsp_info, std::move(cost_matrix));
+	return true;
+}
+
+/**
+ * Reads the optional non-negative number `name` of `request` into
+ * `value`, false with a message in `error` when it isn't one
+ */
+template <typename Number>
+static bool server_number (const JsonValue &request, const char *name, Number &value,
+		std::string &error) {
+	const JsonValue *member = json_member(request, name);
+
+	if (!member)
+		return true;
+
+	if (member->type != JSON_NUMBER || !(member->number >= 0)) {
+		error = std::string("\"") + name + "\" must be a non-negative number";
+		return false;
+	}
+
+	value = member->number;
+	return true;
+}
+
+/**
+ * Reads the optional name `name` of `request` as an id through
+ * `lookup`, false with a message in `error` when it is unknown
+ */
+static bool server_name (const JsonValue &request, const char *name, int (*lookup) (const char *),
+		int &value, std::string &error) {
+	const JsonValue *member = json_member(request, name);
+
+	if (!member)
+		return true;
+
+	int id = member->type == JSON_STRING ? lookup(member->string.c_str()) : 0;
+	if (!id) {
+		error = std::string("Unknown \"") + name + "\"";
+		return false;
+	}
+
+	value = id;
+	return true;
+}
+
+/**
+ * Solves `request` and returns its response line
+ */
+static std::string server_solve (Server &server, const JsonValue &request) {
+	const JsonValue *id = json_member(request, "id");
+	std::string error;
+
+	// the command line options are the defaults of every request
+	Options options = *server.options;
+	options.helper_threads = server.helper_threads;
+	options.quiet = true;
+	options.resume = false;
+	options.checkpoint_path.clear();
+
+	if (!options.search)
+		options.search = BEST_BOUND_SEARCH;
+
+	if (!server_name(request, "search", options_search_id, options.search, error)
+			|| !server_name(request, "bounding", options_bounding_id, options.bounding, error)
+			|| !server_name(request, "branching", options_branching_id, options.branching, error)
+			|| !server_number(request, "lookahead", options.lookahead, error)
+			|| !server_number(request, "time_limit", options.time_limit, error)
+			|| !server_number(request, "node_limit", options.node_limit, error)
+			|| !server_number(request, "gap", options.gap, error)
+			|| !server_number(request, "dive_frequency", options.dive_frequency, error)
+			|| !server_number(request, "dive_depth", options.dive_depth, error)
+			|| !server_number(request, "patch_interval", options.patch_interval, error)
+			|| !server_number(request, "exact_max", options.exact_max, error))
+		return server_error(id, error);
+
+	const JsonValue *exact_max = json_member(request, "exact_max");
+	if (exact_max && exact_max->number > HELD_KARP_MAX)
+		return server_error(id, "\"exact_max\" must be at most " + std::to_string(HELD_KARP_MAX));
+
+	const JsonValue *symmetric = json_member(request, "symmetric");
+	if (symmetric && symmetric->type == JSON_BOOL)
+		options.symmetric = symmetric->boolean;
+
+	options.lookahead = std::max(options.lookahead, 1);
+	options.dive_frequency = std::max(options.dive_frequency, 1L);
+
+	const JsonValue *path = json_member(request, "instance");
+	const JsonValue *matrix = json_member(request, "matrix");
+	TSPInfo tsp_info;
+
+	if (path && path->type == JSON_STRING) {
+		std::shared_ptr<const TSPInfo> instance = server_instance(server, path->string, error);
+		if (!instance)
+			return server_error(id, error);
+
+		// the instance data is shared with the cache, only the
+		// overlay and the results are per request
+		tsp_info = *instance;
+	} else if (matrix) {
+		if (!server_matrix(*matrix, tsp_info, error))
+			return server_error(id, error);
+	} else {
+		return server_error(id, "Missing \"instance\" path or \"matrix\"");
+	}
+
+	tsp_info.upper_bound = INFINITE;
+	tsp_info.bounding = options.bounding;
+	tsp_info.branching = options.branching;
+	tsp_info.lookahead = options.lookahead;
+	tsp_info.symmetric_branching = options.symmetric && tsp_info.cost_matrix->isSymmetric();
+	tsp_info.solve = metrics_new_solve();
+
+	// the cache can be skipped by a request, e.g. to time a solve
+	bool use_cache = !options.cache_dir.empty();
+	const JsonValue *cache = json_member(request, "cache");
+	if (cache && cache->type == JSON_BOOL)
+		use_cache = use_cache && cache->boolean;
+
+	CacheEntry cached;
+	bool from_cache = use_cache && cache_load(options, tsp_info, cached);
+
+	if (!from_cache) {
+		search_run(options.search, tsp_info, options, NULL);
+
+		if (use_cache)
+			cache_store(options, tsp_info, cached);
+	}
+
+	std::ostringstream out;
+	bool found = !tsp_info.best_tour.empty();
+	double gap = search_gap(tsp_info.upper_bound, tsp_info.lower_bound);
+
+	out << "{\"id\":";
+	json_write(out, id ? *id : JsonValue());
+	out << ",\"status\":\"" << search_status_name(tsp_info.status) << "\"";
+
+	out << ",\"cost\":";
+	if (found)
+		json_write_number(out, tsp_info.upper_bound);
+	else
+		out << "null";
+
+	out << ",\"lower_bound\":";
+	json_write_number(out, tsp_info.lower_bound);
+
+	out << ",\"gap\":";
+	if (found)
+		json_write_number(out, gap);
+	else
+		out << "null";
+
+	out << ",\"tour\":[";
+	for (size_t i = 0; i < tsp_info.best_tour.size(); ++i) {
+		if (i)
+			out << ',';
+		out << tsp_info.best_tour[i];
+	}
+	out << "]";
+
+	out << ",\"expanded\":" << tsp_info.stats.expanded
+		<< ",\"generated\":" << tsp_info.stats.generated
+		<< ",\"seconds\":";
+	json_write_number(out, tsp_info.stats.elapsed);
+	out << ",\"cached\":" << (from_cache ? "true" : "false") << "}\n";
+
+	return out.str();
+}
+
+static void server_worker (Server *server) {
+	while (true) {
+		ServerJob job;
+
+		{
+			std::unique_lock<std::mutex> lock (server->mutex);
+			server->job_ready.wait(lock, [server] () {
+				return server->jobs.size() || server->closed; });
+
+			if (server->jobs.empty())
+				return;
+
+			job = std::move(server->jobs.front());
+			server->jobs.pop_front();
+		}
+
+		server->job_taken.notify_one();
+
+		server_write(*job.connection, server_solve(*server, job.request));
+	}
+}
+
+/**
+ * Handles one request line of `connection`: queues it for the
+ * workers, or answers it right away when it can't be parsed,
+ * returns false once the connection should stop reading
+ */
+static bool server_request (Server &server, std::shared_ptr<ServerConnection> &connection,
+		const std::string &line) {
+	if (line.find_first_not_of(" \t\r") == std::string::npos)
+		return true;
+
+	ServerJob job;
+	std::string error;
+
+	if (!json_parse(line, job.request, error)) {
+		server_write(*connection, server_error(NULL, "Invalid request: " + error));
+		return true;
+	}
+
+	if (job.request.type != JSON_OBJECT) {
+		server_write(*connection, server_error(NULL, "Invalid request: not an object"));
+		return true;
+	}
+
+	const JsonValue *command = json_member(job.request, "command");
+	if (command) {
+		if (command->type == JSON_STRING && command->string == "shutdown") {
+			server_stop(server);
+			return false;
+		}
+
+		server_write(*connection, server_error(json_member(job.request, "id"), "Unknown \"command\""));
+		return true;
+	}
+
+	job.connection = connection;
+
+	{
+		std::unique_lock<std::mutex> lock (server.mutex);
+		server.job_taken.wait(lock, [&server] () {
+			return server.jobs.size() < server.queue_limit; });
+
+		server.jobs.push_back(std::move(job));
+	}
+
+	server.job_ready.notify_one();
+	return true;
+}
+
+/**
+ * Reads the request lines of `connection` until its end
+ */
+static void server_read (Server &server, std::shared_ptr<ServerConnection> connection) {
+	std::string pending;
+	char buffer[1 << 16];
+
+	while (true) {
+		ssize_t count = read(connection->in, buffer, sizeof(buffer));
+
+		if (count < 0 && errno == EINTR)
+			continue;
+
+		if (count <= 0)
+			break;
+
+		size_t scanned = pending.size();
+		pending.append(buffer, count);
+
+		size_t start = 0, end;
+		bool reading = true;
+
+		while (reading && (end = pending.find('\n', scanned)) != std::string::npos) {
+			reading = server_request(server, connection, pending.substr(start, end - start));
+			start = scanned = end + 1;
+		}
+
+		pending.erase(0, start);
+
+		if (!reading)
+			return;
+
+		if (pending.size() > SERVER_MAX_LINE) {
+			server_write(*connection, server_error(NULL, "Request too long"));
+			return;
+		}
+	}
+
+	// a last request without its newline
+	server_request(server, connection, pending);
+}
+
+static void server_reader (Server *server, std::shared_ptr<ServerConnection> connection) {
+	server_read(*server, connection);
+
+	std::lock_guard<std::mutex> lock (server->mutex);
+	server->connections.erase(connection->in);
+	--server->readers;
+	server->readers_done.notify_all();
+}
+
+/**
+ * Accepts connections on the Unix socket at `path` until a shutdown
+ * request, a reader thread per connection
+ */
+static int server_listen (Server &server, const std::string &path) {
+	sockaddr_un address = sockaddr_un();
+	address.sun_family = AF_UNIX;
+
+	if (path.size() >= sizeof(address.sun_path)) {
+		std::cerr << "Socket path too long: " << path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	path.copy(address.sun_path, path.size());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(path.c_str());
+
+	if (listener < 0 || bind(listener, (sockaddr *) &address, sizeof(address)) != 0
+			|| listen(listener, SOMAXCONN) != 0) {
+		std::cerr << "Could not listen on " << path << ": " << strerror(errno) << std::endl;
+		if (listener >= 0)
+			close(listener);
+		return EXIT_FAILURE;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (server.mutex);
+		server.listener = listener;
+	}
+
+	while (true) {
+		int fd = accept(listener, NULL, NULL);
+
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			break;
+		}
+
+		std::shared_ptr<ServerConnection> connection (new ServerConnection());
+		connection->in = connection->out = fd;
+		connection->owned = true;
+
+		std::lock_guard<std::mutex> lock (server.mutex);
+		if (server.stopping)
+			break;
+
+		server.connections.insert(fd);
+		++server.readers;
+		std::thread(server_reader, &server, connection).detach();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (server.mutex);
+		server.listener = -1;
+	}
+
+	close(listener);
+	unlink(path.c_str());
+
+	return EXIT_SUCCESS;
+}
+
+int server_run (Options &options) {
+	// a client that leaves before its results shouldn't end the server
+	signal(SIGPIPE, SIG_IGN);
+
+	int workers = options.workers > 0 ? options.workers
+		: std::max(1u, std::thread::hardware_concurrency());
+
+	Server server;
+	server.options = &options;
+	server.helper_threads = std::max(1, options_helper_threads(options) / workers);
+	server.queue_limit = (size_t) workers * SERVER_QUEUE_PER_WORKER;
+	server.closed = false;
+	server.stopping = false;
+	server.listener = -1;
+	server.readers = 0;
+	server.cache_clock = 0;
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < workers; ++i) {
+		threads.push_back(std::thread(server_worker, &server));
+	}
+
+	int status = EXIT_SUCCESS;
+
+	if (options.socket_path.empty()) {
+		std::shared_ptr<ServerConnection> connection (new ServerConnection());
+		connection->in = STDIN_FILENO;
+		connection->out = STDOUT_FILENO;
+		connection->owned = false;
+
+		server_read(server, connection);
+	} else {
+		status = server_listen(server, options.socket_path);
+	}
+
+	// the requests already read are still answered
+	{
+		std::unique_lock<std::mutex> lock (server.mutex);
+		server.readers_done.wait(lock, [&server] () { return server.readers == 0; });
+		server.closed = true;
+	}
+
+	server.job_ready.notify_all();
+
+	for (size_t i = 0; i < threads.size(); ++i) {
+		threads[i].join();
+	}
+
+	return status;
+}
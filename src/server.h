@@ -0,0 +1,39 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "options.h"
+
+/**
+ * Long-lived solver service: requests are read as JSON lines from
+ * stdin or, with --socket, from any number of connections to a Unix
+ * socket, and solved concurrently by a fixed set of worker threads.
+ * The workers outlive the requests, so their node pools and
+ * assignment workspaces stay allocated from one solve to the next,
+ * and instance files are parsed once and kept while they don't
+ * change on disk.
+ *
+ * A request is an object such as
+ *
+ *   {"id": 7, "instance": "instances/gr17.tsp", "search": "hybrid",
+ *    "time_limit": 10}
+ *
+ * where the instance is either a TSPLIB file ("instance") or an
+ * inline square cost matrix ("matrix", rows of integers, null for
+ * an arc that can't be used). The optional fields mirror the command
+ * line options, whose values are the defaults: "search", "bounding",
+ * "branching", "lookahead", "time_limit", "node_limit", "gap",
+ * "dive_frequency", "dive_depth", "patch_interval", "exact_max" and
+ * "symmetric" (a boolean).
+ * With --cache, "cache": false solves a request without the result
+ * cache. {"command": "shutdown"} stops the server once the requests
+ * already read are answered.
+ *
+ * Every request gets one JSON line back, on the stream it came from,
+ * as soon as it is solved (so not necessarily in order), carrying
+ * its "id" and a "status": "optimal", "time_limit", "node_limit",
+ * "gap_limit" along with the result ("cached" when it comes from the
+ * result cache), or "error" with a message.
+ */
+int server_run (Options &options);
+
+#endif
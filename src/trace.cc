@@ -0,0 +1,187 @@
+#include <fstream> // ofstream
+#include <iomanip> // setprecision
+#include <vector> // vector
+#include <memory> // unique_ptr
+#include <mutex> // mutex
+#include <atomic> // atomic
+#include <chrono> // steady_clock
+#include "trace.h"
+
+// events kept per thread, older ones are overwritten
+#define TRACE_BUFFER_EVENTS (1 << 20)
+
+bool trace_enabled = false;
+
+typedef struct s_trace_event {
+	const char *name;
+
+	/**
+	 * 'X' for a complete span, 'i' for an instant event
+	 */
+	char phase;
+
+	uint64_t start;
+	uint64_t duration;
+	double value;
+} TraceEvent;
+
+/**
+ * Ring of one thread at a time: only that thread writes `events`
+ * and `written`, the dump reads them once the search is over
+ */
+typedef struct s_trace_buffer {
+	int tid;
+	std::vector<TraceEvent> events;
+	std::atomic<uint64_t> written;
+} TraceBuffer;
+
+static std::string trace_path;
+static uint64_t trace_origin;
+
+static std::mutex trace_buffers_mutex;
+static std::vector< std::unique_ptr<TraceBuffer> > trace_buffers;
+
+/**
+ * Buffers of the threads that exited, the next threads record into
+ * them instead of allocating their own: short lived threads (those
+ * of a portfolio, of the autotuning probes) take as many buffers as
+ * ever ran at once, not one each
+ */
+static std::vector<TraceBuffer *> trace_free_buffers;
+
+/**
+ * Buffer of a thread, handed back to trace_free_buffers when the
+ * thread exits
+ */
+typedef struct s_trace_owner {
+	TraceBuffer *buffer = NULL;
+
+	~s_trace_owner () {
+		if (!buffer)
+			return;
+
+		std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+		trace_free_buffers.push_back(buffer);
+	}
+} TraceOwner;
+
+/**
+ * Buffer of the calling thread, taken on its first event
+ */
+static TraceBuffer &trace_buffer () {
+	thread_local TraceOwner owner;
+
+	if (!owner.buffer) {
+		std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+
+		if (trace_free_buffers.size()) {
+			// the events of its previous threads are kept, the
+			// new ones follow on the same track
+			owner.buffer = trace_free_buffers.back();
+			trace_free_buffers.pop_back();
+		} else {
+			trace_buffers.emplace_back(new TraceBuffer);
+			owner.buffer = trace_buffers.back().get();
+			owner.buffer->tid = trace_buffers.size();
+			owner.buffer->events.resize(TRACE_BUFFER_EVENTS);
+			owner.buffer->written = 0;
+		}
+	}
+
+	return *owner.buffer;
+}
+
+static void trace_record (const TraceEvent &event) {
+	TraceBuffer &buffer = trace_buffer();
+	uint64_t slot = buffer.written.load(std::memory_order_relaxed);
+
+	buffer.events[slot % TRACE_BUFFER_EVENTS] = event;
+	buffer.written.store(slot + 1, std::memory_order_release);
+}
+
+uint64_t trace_now () {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_span (const char *name, uint64_t start) {
+	TraceEvent event;
+	event.name = name;
+	event.phase = 'X';
+	event.start = start;
+	event.duration = trace_now() - start;
+	event.value = 0;
+
+	trace_record(event);
+}
+
+void trace_instant (const char *name, double value) {
+	if (!trace_enabled)
+		return;
+
+	TraceEvent event;
+	event.name = name;
+	event.phase = 'i';
+	event.start = trace_now();
+	event.duration = 0;
+	event.value = value;
+
+	trace_record(event);
+}
+
+void trace_start (const std::string &path) {
+	trace_path = path;
+	trace_enabled = true;
+
+	// registers the calling thread now, so allocating its buffer
+	// doesn't show up in the first span
+	trace_buffer();
+	trace_origin = trace_now();
+}
+
+bool trace_dump () {
+	if (!trace_enabled)
+		return true;
+
+	std::ofstream out(trace_path, std::ios::out | std::ios::trunc);
+	if (!out)
+		return false;
+
+	std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+
+	// timestamps are in microseconds relative to trace_start()
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	bool first = true;
+	for (size_t b = 0; b < trace_buffers.size(); ++b) {
+		TraceBuffer &buffer = *trace_buffers[b];
+		uint64_t written = buffer.written.load(std::memory_order_acquire);
+		uint64_t oldest = written > TRACE_BUFFER_EVENTS ? written - TRACE_BUFFER_EVENTS : 0;
+
+		out << (first ? "" : ",")
+			<< "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.tid
+			<< ",\"args\":{\"name\":\"search " << buffer.tid << "\"}}";
+		first = false;
+
+		for (uint64_t k = oldest; k < written; ++k) {
+			const TraceEvent &event = buffer.events[k % TRACE_BUFFER_EVENTS];
+
+			out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+				<< "\",\"pid\":1,\"tid\":" << buffer.tid
+				<< ",\"ts\":" << (event.start - trace_origin) / 1000.0;
+
+			if (event.phase == 'X')
+				out << ",\"dur\":" << event.duration / 1000.0;
+			else
+				out << ",\"s\":\"t\",\"args\":{\"value\":" << event.value << "}";
+
+			out << "}";
+		}
+	}
+
+	out << "\n]}\n";
+	out.close();
+
+	return !out.fail();
+}
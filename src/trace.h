@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string> // string
+#include <cstdint> // uint64_t
+
+/**
+ * Optional execution tracing in the Chrome trace event format,
+ * which loads in Perfetto (ui.perfetto.dev) and chrome://tracing
+ *
+ * Each thread records into its own ring buffer, so recording takes
+ * no lock; when the buffer is full the oldest events are dropped.
+ * While tracing is off every probe costs one predictable branch.
+ */
+
+/**
+ * Only written by trace_start(), before the search starts
+ */
+extern bool trace_enabled;
+
+uint64_t trace_now ();
+
+/**
+ * Records a span that started at `start` (a trace_now() value)
+ * and ends now
+ */
+void trace_span (const char *name, uint64_t start);
+
+/**
+ * Records an instant event carrying a value, e.g. the cost of a
+ * new incumbent
+ */
+void trace_instant (const char *name, double value);
+
+/**
+ * Turns tracing on, the events will be written to `path`
+ */
+void trace_start (const std::string &path);
+
+/**
+ * Writes the recorded events of every thread to the path given
+ * to trace_start(), returns false when the file can't be written
+ */
+bool trace_dump ();
+
+/**
+ * Times the enclosing scope
+ */
+class TraceScope
+{
+	public:
+		explicit TraceScope (const char *name) : name(name), start(0) {
+			if (trace_enabled)
+				start = trace_now();
+		}
+
+		~TraceScope () {
+			if (trace_enabled)
+				trace_span(name, start);
+		}
+
+	private:
+		const char *name;
+		uint64_t start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__) (name)
+
+#endif
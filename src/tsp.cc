@@ -1,34 +1,132 @@
+#include <utility> // move
+#include <vector> // vector
+#include <algorithm> // min, max
+#include <memory> // unique_ptr, shared_ptr
+#include <new> // bad_alloc
 #include "tsp.h"
 #include "data.h"
+#include "bounding.h"
+#include "branching.h"
 
-void tsp_init (TSPInfo &tsp_info, int argc, char **argv) {
+/**
+ * Sets up the instance read by `data`
+ */
+static void tsp_init_data (TSPInfo &tsp_info, Data *data, int threads) {
+	tsp_info.dimension = data->getDimension();
+	tsp_info.bounding = BOUNDING_AP;
+	tsp_info.branching = BRANCHING_SMALLEST;
+	tsp_info.lookahead = DEFAULT_LOOKAHEAD;
+
+	tsp_info.spatial_index.reset();
+	tsp_info.neighbours.reset();
+	tsp_info.neighbour_count = 0;
+
+	if (data->getExplicitCoord()) {
+		std::vector<double> x (tsp_info.dimension), y (tsp_info.dimension);
+		for (int i = 0; i < tsp_info.dimension; ++i) {
+			x[i] = data->getXCoord(i);
+			y[i] = data->getYCoord(i);
+		}
+
+		std::shared_ptr<KdTree> tree (new KdTree());
+		std::shared_ptr<std::vector<int> > neighbours (new std::vector<int>());
+
+		kdtree_build(*tree, x.data(), y.data(), tsp_info.dimension, threads);
+		tsp_info.neighbour_count = std::min(TSP_NEIGHBOURS, tsp_info.dimension -1);
+		kdtree_neighbour_lists(*tree, tsp_info.neighbour_count, *neighbours, threads);
+
+		tsp_info.spatial_index = tree;
+		tsp_info.neighbours = neighbours;
+	}
+
+	// the loader already picked the storage, the matrix is moved
+	// so it never exists twice
+	tsp_info.cost_matrix = std::make_shared<const CostMatrix>(std::move(data->getMatrixCost()));
+	tsp_info.symmetric_branching = tsp_info.cost_matrix->isSymmetric();
+	tsp_info.solver_costs.reset();
+	tsp_info.cost_overlay.clear();
+	tsp_info.shared = NULL;
+	tsp_info.solve = 0;
+}
+
+void tsp_init (TSPInfo &tsp_info, int argc, char **argv, int threads) {
 	Data *data = new Data(argc, argv[1]);
 	data->readData();
 
-	tsp_info.dimension = data->getDimension();
+	tsp_init_data(tsp_info, data, threads);
 
-	tsp_info.cost_matrix = new double*[tsp_info.dimension];
-	tsp_info.cost_copy = new double*[tsp_info.dimension];
+    delete data;
+}
 
-	for (int i = 0; i < tsp_info.dimension; i++){
-		tsp_info.cost_matrix[i] = new double[tsp_info.dimension];
-		tsp_info.cost_copy[i] = new double[tsp_info.dimension];
+bool tsp_load (TSPInfo &tsp_info, const std::string &path, int threads, std::string &error) {
+	std::unique_ptr<Data> data (new Data(2, const_cast<char *>(path.c_str())));
 
-		for (int j = 0; j < tsp_info.dimension; j++){
-			tsp_info.cost_matrix[i][j] = data->getDistance(i, j);
-			tsp_info.cost_copy[i][j] = tsp_info.cost_matrix[i][j];
-		}
+	try {
+		if (!data->loadData(error))
+			return false;
+
+		tsp_init_data(tsp_info, data.get(), threads);
+	} catch (const std::bad_alloc &) {
+		error = "Instance " + path + " is too large";
+		return false;
 	}
 
-    delete data;
+	return true;
 }
 
-void tsp_free (TSPInfo &tsp_info) {
-    for (int i = 0; i < tsp_info.dimension; i++) {
-		delete [] tsp_info.cost_matrix[i];
-		delete [] tsp_info.cost_copy[i];
+void tsp_init_matrix (TSPInfo &tsp_info, CostMatrix &&cost_matrix) {
+	tsp_info.dimension = cost_matrix.getDimension();
+	tsp_info.bounding = BOUNDING_AP;
+	tsp_info.branching = BRANCHING_SMALLEST;
+	tsp_info.lookahead = DEFAULT_LOOKAHEAD;
+
+	tsp_info.spatial_index.reset();
+	tsp_info.neighbours.reset();
+	tsp_info.neighbour_count = 0;
+
+	for (int i = 0; i < tsp_info.dimension; ++i) {
+		cost_matrix.set(i, i, INFINITE);
+	}
+
+	if (cost_matrix.checkSymmetric())
+		cost_matrix.pack();
+
+	tsp_info.cost_matrix = std::make_shared<const CostMatrix>(std::move(cost_matrix));
+	tsp_info.symmetric_branching = tsp_info.cost_matrix->isSymmetric();
+	tsp_info.solver_costs.reset();
+	tsp_info.cost_overlay.clear();
+	tsp_info.shared = NULL;
+	tsp_info.solve = 0;
+}
+
+void tsp_prepare (TSPInfo &tsp_info) {
+	if (tsp_info.solver_costs)
+		return;
+
+	const CostMatrix &cost_matrix = *tsp_info.cost_matrix;
+	int dimension = tsp_info.dimension;
+	bool symmetric = cost_matrix.isSymmetric();
+
+	// packed like the matrix, a symmetric instance never has its
+	// costs in full but in the matrix of the node being solved
+	std::shared_ptr<SolverCosts> costs (new SolverCosts());
+	costs->resize(dimension, symmetric);
+
+	for (int i = 0; i < dimension; ++i) {
+		// truncated, as the hungarian did when filling its matrix
+		for (int j = symmetric ? i : 0; j < dimension; ++j) {
+			costs->set(i, j, cost_matrix.get(i, j));
+		}
 	}
 
-	delete [] tsp_info.cost_matrix;
-	delete [] tsp_info.cost_copy;
+	tsp_info.solver_costs = costs;
+}
+
+void tsp_free (TSPInfo &tsp_info) {
+	tsp_info.cost_matrix.reset();
+	tsp_info.solver_costs.reset();
+	tsp_info.cost_overlay.clear();
+	tsp_info.spatial_index.reset();
+	tsp_info.neighbours.reset();
+	tsp_info.neighbour_count = 0;
 }
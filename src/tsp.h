@@ -1,11 +1,88 @@
 #ifndef TSP_INFO_H
 #define TSP_INFO_H
 
+#include <vector> // vector
+#include <memory> // shared_ptr
+#include <string> // string
+#include "cost_matrix.h"
+#include "kdtree.h"
+
+// length of the neighbour lists kept for every city
+#define TSP_NEIGHBOURS 10
+
+typedef struct s_search_stats {
+	/**
+	 * Nodes taken from the tree and branched
+	 */
+	long expanded;
+
+	/**
+	 * Children evaluated with the hungarian method
+	 */
+	long generated;
+
+	/**
+	 * Seconds spent searching, including runs this one resumed
+	 */
+	double elapsed;
+} SearchStats;
+
 typedef struct s_tsp_info {
 	int dimension;
 
-	double **cost_matrix;
-	double **cost_copy;
+	/**
+	 * Instance costs, packed when the instance is symmetric
+	 *
+	 * The instance data below is never written once set up, so the
+	 * copies of this TSPInfo (the searches of a portfolio, the
+	 * threads of a parallel search, the requests of a server) share
+	 * it instead of copying it; each node only applies its
+	 * cost_overlay on top.
+	 */
+	std::shared_ptr<const CostMatrix> cost_matrix;
+
+	/**
+	 * Spatial index over the coordinates of the cities and the
+	 * TSP_NEIGHBOURS nearest neighbours of each one (those of city i
+	 * at [i * neighbour_count, (i + 1) * neighbour_count)), both
+	 * NULL when the instance has no coordinates
+	 */
+	std::shared_ptr<const KdTree> spatial_index;
+	std::shared_ptr<const std::vector<int> > neighbours;
+	int neighbour_count;
+
+	/**
+	 * cost_matrix converted once to the integers the assignment
+	 * solvers work on, in the same (packed or full) layout, NULL
+	 * until tsp_prepare() builds it
+	 */
+	std::shared_ptr<const SolverCosts> solver_costs;
+
+	/**
+	 * Entries of cost_matrix overridden while a node is evaluated
+	 * (its prohibited edges)
+	 */
+	CostOverlay cost_overlay;
+
+	/**
+	 * Relaxation used for the node bounds (BOUNDING_AP or
+	 * BOUNDING_ADDITIVE, see bounding.h)
+	 */
+	int bounding;
+
+	/**
+	 * Rule choosing the subtour a node is branched on, and the
+	 * number of candidate subtours of BRANCHING_STRONG (see
+	 * branching.h)
+	 */
+	int branching;
+	int lookahead;
+
+	/**
+	 * Branch on undirected edges, prohibiting both arcs at once (see
+	 * branching_child_edges), only set on symmetric instances
+	 */
+	bool symmetric_branching;
 
 	/**
 	 * The upper bound is defined as the cost of a valid TSP solution
@@ -17,9 +94,66 @@ typedef struct s_tsp_info {
 	 * further unecessary calculations
 	 */
 	double upper_bound;
+
+	/**
+	 * Global lower bound left by the last search: the lowest bound
+	 * among its open nodes, equal to the upper bound when the tree
+	 * was exhausted
+	 */
+	double lower_bound;
+
+	/**
+	 * Why the last search returned (SEARCH_COMPLETE or one of the
+	 * SEARCH_*_LIMIT codes in search.h)
+	 */
+	int status;
+
+	/**
+	 * Tour whose cost is the upper bound, as a closed sequence of
+	 * cities (first city repeated at the end), empty if none was found
+	 */
+	std::vector<int> best_tour;
+
+	SearchStats stats;
+
+	/**
+	 * Incumbent shared with the other searches of a portfolio, NULL
+	 * when the search runs alone (see search.h)
+	 */
+	struct s_search_shared *shared;
+
+	/**
+	 * Solve the searches of this instance report their metrics
+	 * under (see metrics_new_solve), kept by the copies made for the
+	 * threads of a parallel search and the members of a portfolio
+	 */
+	long solve;
 } TSPInfo;
 
-void tsp_init (TSPInfo &tsp_info, int argc, char **argv);
+/**
+ * Reads the instance named in argv, building its k-d tree on up to
+ * `threads` threads
+ */
+void tsp_init (TSPInfo &tsp_info, int argc, char **argv, int threads);
+
+/**
+ * Same as tsp_init for the instance file at `path`, but returns false
+ * with a message in `error` when it can't be read instead of ending
+ * the process
+ */
+bool tsp_load (TSPInfo &tsp_info, const std::string &path, int threads, std::string &error);
+
+/**
+ * Sets up an instance given by its costs instead of a file: the
+ * matrix is moved in, it is packed when symmetric and its diagonal
+ * is prohibited
+ */
+void tsp_init_matrix (TSPInfo &tsp_info, CostMatrix &&cost_matrix);
+
+/**
+ * Builds tsp_info.solver_costs, if it isn't yet
+ */
+void tsp_prepare (TSPInfo &tsp_info);
 
 void tsp_free (TSPInfo &tsp_info);
 
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Branching rules: each one finds the optimum under the best first and
+# depth first searches, run from the top directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+
+status=0
+
+# expect INSTANCE OPTIMUM SEARCH BRANCHING
+expect () {
+	output=$(timeout 120 "$BNB" "instances/$1.tsp" --search "$3" --branching "$4" \
+		--exact-max 0 2>&1)
+
+	case "$output" in
+	*"Cost: $2
+Lower bound: $2"*)
+		echo "ok   $1 --search $3 --branching $4" ;;
+	*)
+		echo "FAIL $1 --search $3 --branching $4: expected cost $2 in: $output"
+		status=1 ;;
+	esac
+}
+
+for branching in smallest regret bound strong; do
+	for search in best depth; do
+		expect burma14 3323 $search $branching
+		expect gr21 2707 $search $branching
+	done
+
+	# the average regret of its arcs used to leave gr17 unsolved
+	expect gr17 2085 best $branching
+done
+
+exit $status
@@ -0,0 +1,65 @@
+#!/bin/sh
+# Result cache: misses, hits, and entries whose proof isn't trusted,
+# run from the top directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+status=0
+
+# solve: gr24 solved through the cache, its output goes to $output
+solve () {
+	output=$(timeout 120 "$BNB" instances/gr24.tsp --search best --exact-max 0 \
+		--cache "$TMP/cache" 2>&1)
+}
+
+# expect NAME TEXT: the last output contains TEXT
+expect () {
+	case "$output" in
+	*"$2"*)
+		echo "ok   $1" ;;
+	*)
+		echo "FAIL $1: expected $2 in: $output"
+		status=1 ;;
+	esac
+}
+
+# refuse NAME TEXT: the last output doesn't contain TEXT
+refuse () {
+	case "$output" in
+	*"$2"*)
+		echo "FAIL $1: unexpected $2 in: $output"
+		status=1 ;;
+	*)
+		echo "ok   $1" ;;
+	esac
+}
+
+solve
+refuse "miss" "Result from cache"
+expect "miss solves" "Cost: 1272"
+
+solve
+expect "hit" "Result from cache"
+expect "hit is optimal" "Cost: 1272
+Lower bound: 1272"
+
+# an entry of the first version claims a worse tour is optimal, as
+# the directed search of that solver could
+entry=$(ls "$TMP"/cache/*.result)
+key=$(sed -n 's/^key //p' "$entry")
+printf 'BNB-CACHE 1\nkey %s\ndimension 24\ncomplete 1\nupper_bound 1282\nlower_bound 1282\nstats 4022 7324 0.1\ntour 25 1 16 11 3 7 24 6 8 21 5 10 17 22 18 19 15 2 20 14 13 9 23 4 12 1\n' \
+	"$key" > "$entry"
+
+solve
+refuse "untrusted proof" "Result from cache"
+expect "untrusted proof warm starts" "Starting from cached incumbent 1282"
+expect "untrusted proof solves" "Cost: 1272
+Lower bound: 1272"
+
+solve
+expect "untrusted proof is replaced" "Result from cache"
+expect "replaced proof is optimal" "Cost: 1272"
+
+exit $status
@@ -0,0 +1,103 @@
+#!/bin/sh
+# Checkpoints: a search stopped or killed midway resumes from its last
+# snapshot to the optimum, run from the top directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+status=0
+
+# interrupt NAME INSTANCE SECONDS ARGS...: the search of INSTANCE
+# with ARGS is killed after SECONDS, its checkpoint must be there
+interrupt () {
+	name=$1
+	instance=$2
+	seconds=$3
+	shift 3
+	rm -f "$TMP/checkpoint"
+
+	timeout -s KILL "$seconds" "$BNB" "instances/$instance.tsp" --exact-max 0 \
+		--checkpoint "$TMP/checkpoint" --checkpoint-interval 0.2 "$@" > /dev/null 2>&1
+
+	if [ -s "$TMP/checkpoint" ]; then
+		echo "ok   $name: saved"
+	else
+		echo "FAIL $name: no checkpoint after $seconds seconds"
+		status=1
+	fi
+}
+
+# stop NAME INSTANCE ARGS...: the search of INSTANCE with ARGS ends
+# at a node limit and leaves open nodes in its checkpoint
+stop () {
+	name=$1
+	instance=$2
+	shift 2
+	rm -f "$TMP/checkpoint"
+
+	output=$(timeout 300 "$BNB" "instances/$instance.tsp" --exact-max 0 --node-limit 100 \
+		--checkpoint "$TMP/checkpoint" "$@" 2>&1)
+
+	case "$output" in
+	*"Stopped: node limit"*)
+		if grep -q '^frontier [1-9]' "$TMP/checkpoint" 2> /dev/null; then
+			echo "ok   $name: saved"
+		else
+			echo "FAIL $name: no open nodes in the checkpoint"
+			status=1
+		fi ;;
+	*)
+		echo "FAIL $name: expected a node limit in: $output"
+		status=1 ;;
+	esac
+}
+
+# resume NAME INSTANCE OPTIMUM ARGS...: resuming with ARGS proves
+# OPTIMUM
+resume () {
+	name=$1
+	instance=$2
+	optimum=$3
+	shift 3
+
+	output=$(timeout 300 "$BNB" "instances/$instance.tsp" --exact-max 0 \
+		--resume --checkpoint "$TMP/checkpoint" "$@" 2>&1)
+
+	case "$output" in
+	*"Cost: $optimum
+Lower bound: $optimum"*)
+		echo "ok   $name: resumed" ;;
+	*)
+		echo "FAIL $name: expected the optimum $optimum in: $output"
+		status=1 ;;
+	esac
+}
+
+for search in best breadth depth hybrid; do
+	stop "$search" fri26 --search $search
+	resume "$search" fri26 937 --search $search
+done
+
+# the first version has no next child and child bounds on its nodes,
+# all of their children are created again
+stop "version 1" fri26 --search best
+awk 'NR == 1 { print "BNB-CHECKPOINT 1"; next }
+	nodes {
+		last = 4 + 2 * $3
+		line = $1
+		for (i = 2; i < last; ++i) line = line " " $i
+		for (i = last + 2 + $(last + 1); i <= NF; ++i) line = line " " $i
+		print line
+		next
+	}
+	$1 == "frontier" { nodes = 1 }
+	{ print }' "$TMP/checkpoint" > "$TMP/version1"
+mv "$TMP/version1" "$TMP/checkpoint"
+resume "version 1" fri26 937 --search best
+
+# the threads of a parallel search pause while the first one saves
+interrupt "parallel best" fri26 2 --search best --symmetric off --threads 2
+resume "parallel best" fri26 937 --symmetric off --threads 2
+
+exit $status
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Branch and bound against Held-Karp: a search that claims a closed
+# gap must find the dynamic programming optimum, run from the top
+# directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+
+status=0
+
+# cost INSTANCE ARGS...: the cost the solver prints
+cost () {
+	instance=$1
+	shift
+	timeout 300 "$BNB" "instances/$instance.tsp" "$@" 2>&1 | sed -n 's/^Cost: //p'
+}
+
+# expect INSTANCE OPTIMUM ARGS...: the search proves OPTIMUM
+expect () {
+	instance=$1
+	optimum=$2
+	shift 2
+	output=$(timeout 300 "$BNB" "instances/$instance.tsp" --exact-max 0 "$@" 2>&1)
+
+	case "$output" in
+	*"Cost: $optimum
+Lower bound: $optimum"*)
+		echo "ok   $instance $*" ;;
+	*)
+		echo "FAIL $instance $*: expected the optimum $optimum in: $output"
+		status=1 ;;
+	esac
+}
+
+# ending the siblings of a closed child gave gr24 1282 with a 0% gap,
+# the directed gr17 runs take a minute or two each
+for instance in gr17 gr24; do
+	optimum=$(cost "$instance" --search depth --exact-max 24)
+
+	for search in best breadth depth hybrid auto portfolio; do
+		for symmetric in on off; do
+			expect "$instance" "$optimum" --search $search --symmetric $symmetric
+		done
+	done
+
+	for symmetric in on off; do
+		expect "$instance" "$optimum" --search best --symmetric $symmetric --threads 2
+	done
+done
+
+exit $status
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Instance generator: each layout gives the same file for the same
+# seed, one the solver reads and solves to the Held-Karp optimum; run
+# from the top directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+GENERATE=${GENERATE:-./generate.out}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+status=0
+
+# cost FILE ARGS...: the cost the solver prints
+cost () {
+	file=$1
+	shift
+	timeout 120 "$BNB" "$file" "$@" 2>&1 | sed -n 's/^Cost: //p'
+}
+
+for type in uniform clustered grid asymmetric; do
+	"$GENERATE" --type $type --n 14 --seed 7 --cluster-size 4 --output "$TMP/$type.tsp"
+	"$GENERATE" --type $type --n 14 --seed 7 --cluster-size 4 > "$TMP/again.tsp"
+
+	if cmp -s "$TMP/$type.tsp" "$TMP/again.tsp"; then
+		echo "ok   $type: reproduced"
+	else
+		echo "FAIL $type: seed 7 gave two different instances"
+		status=1
+	fi
+
+	optimum=$(cost "$TMP/$type.tsp" --search depth --exact-max 14)
+	output=$(timeout 120 "$BNB" "$TMP/$type.tsp" --search best --exact-max 0 2>&1)
+
+	case "$output" in
+	*"Cost: $optimum
+Lower bound: $optimum"*)
+		echo "ok   $type: solved" ;;
+	*)
+		echo "FAIL $type: expected the optimum $optimum in: $output"
+		status=1 ;;
+	esac
+done
+
+exit $status
@@ -0,0 +1,84 @@
+#!/bin/sh
+# Limits: a search stopped by its time, node or gap limit says which
+# one, and what it reports still holds; run from the top directory by
+# `make check`
+
+BNB=${BNB:-./bnb.out}
+
+status=0
+
+# bays29 has the optimum 2020
+OPTIMUM=2020
+
+# expect NAME STOPPED ARGS...: bays29 searched with ARGS stops with
+# the message STOPPED, its tour and bound on both sides of the optimum
+expect () {
+	name=$1
+	stopped=$2
+	shift 2
+	output=$(timeout 120 "$BNB" instances/bays29.tsp --exact-max 0 "$@" 2>&1)
+
+	case "$output" in
+	*"Stopped: $stopped"*)
+		;;
+	*)
+		echo "FAIL $name: expected Stopped: $stopped in: $output"
+		status=1
+		return ;;
+	esac
+
+	if echo "$output" | awk -v optimum=$OPTIMUM '
+			/^Cost: / { cost = $2 }
+			/^Lower bound: / { bound = $3 }
+			END { exit !(cost >= optimum && bound <= optimum) }'; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: cost below or lower bound above $OPTIMUM in: $output"
+		status=1
+	fi
+}
+
+# the bound of the depth first search rises slowly, it closes a 5% gap
+# only near the end
+for search in best depth; do
+	expect "$search node limit" "node limit" --search $search --node-limit 100
+	expect "$search time limit" "time limit" --search $search --time-limit 0.01
+	expect "$search gap limit" "gap limit" --search $search --gap 0.15
+done
+
+expect "parallel node limit" "node limit" --search best --threads 2 --node-limit 100
+
+# a node limit of 100 expands exactly that many nodes
+output=$(timeout 120 "$BNB" instances/bays29.tsp --search best --exact-max 0 --node-limit 100 2>&1)
+case "$output" in
+*"Nodes: 100 expanded"*)
+	echo "ok   node count" ;;
+*)
+	echo "FAIL node count: expected 100 expanded nodes in: $output"
+	status=1 ;;
+esac
+
+# gap 0.05 ends with a gap of 5% at most
+output=$(timeout 120 "$BNB" instances/bays29.tsp --search best --exact-max 0 --gap 0.05 2>&1)
+if echo "$output" | awk '/^Gap: / { gap = $2 + 0 } END { exit !(gap <= 5) }'; then
+	echo "ok   gap"
+else
+	echo "FAIL gap: expected a gap of 5% at most in: $output"
+	status=1
+fi
+
+# the server names the limit that stopped each request
+for limit in '"node_limit":100:node_limit' '"time_limit":0.01:time_limit' '"gap":0.05:gap_limit'; do
+	request="{\"id\":1,\"instance\":\"instances/bays29.tsp\",\"exact_max\":0,\"search\":\"best\",${limit%:*}}"
+	response=$(printf '%s\n' "$request" | timeout 60 "$BNB" --serve --workers 1)
+
+	case "$response" in
+	*"\"status\":\"${limit##*:}\""*)
+		echo "ok   server ${limit##*:}" ;;
+	*)
+		echo "FAIL server ${limit##*:}: expected the status ${limit##*:} in: $response"
+		status=1 ;;
+	esac
+done
+
+exit $status
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Portfolio search: the member that finishes first stops the others,
+# its proof must hold; run from the top directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+status=0
+
+# expect NAME TEXT ARGS...: the output of gr24 solved by the
+# portfolio with ARGS contains TEXT
+expect () {
+	name=$1
+	text=$2
+	shift 2
+	output=$(timeout 300 "$BNB" instances/gr24.tsp --search portfolio --exact-max 0 "$@" 2>&1)
+
+	case "$output" in
+	*"$text"*)
+		echo "ok   $name" ;;
+	*)
+		echo "FAIL $name: expected $text in: $output"
+		status=1 ;;
+	esac
+}
+
+# a directed member that ended the siblings of its closed children
+# stopped the others with 1282
+expect "directed members" "Cost: 1272
+Lower bound: 1272" --symmetric off --portfolio best,breadth,hybrid
+
+expect "mixed members" "Cost: 1272
+Lower bound: 1272" --portfolio depth:additive,best:regret,hybrid:bound
+
+expect "checkpoint refused" "can't be used with the portfolio" --checkpoint "$TMP/checkpoint"
+
+if [ -e "$TMP/checkpoint" ]; then
+	echo "FAIL checkpoint refused: $TMP/checkpoint was written"
+	status=1
+fi
+
+exit $status
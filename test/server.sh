@@ -0,0 +1,57 @@
+#!/bin/sh
+# Server mode: responses to requests of inline matrices and instance
+# files, run from the top directory by `make check`
+
+BNB=${BNB:-./bnb.out}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+status=0
+
+# expect NAME REQUEST TEXT: the response to REQUEST contains TEXT
+expect () {
+	response=$(printf '%s\n' "$2" | timeout 60 "$BNB" --serve --workers 1)
+
+	case "$response" in
+	*"$3"*)
+		echo "ok   $1" ;;
+	*)
+		echo "FAIL $1: expected $3 in: $response"
+		status=1 ;;
+	esac
+}
+
+# the tour 1-2-3 costs 3 * 1500003, printed in full
+expect "costs above 1e6" \
+	'{"id":1,"matrix":[[null,1500003,2000000],[2000000,null,1500003],[1500003,2000000,null]]}' \
+	'"cost":4500009,"lower_bound":4500009,'
+
+expect "costs above 1e6, searched" \
+	'{"id":2,"exact_max":0,"matrix":[[null,1500003,2000000],[2000000,null,1500003],[1500003,2000000,null]]}' \
+	'"cost":4500009,"lower_bound":4500009,'
+
+expect "instance file" \
+	'{"id":3,"instance":"instances/burma14.tsp","exact_max":0}' \
+	'"status":"optimal","cost":3323,'
+
+expect "missing instance file" \
+	"{\"id\":4,\"instance\":\"$TMP/missing.tsp\"}" \
+	'"id":4,"status":"error"'
+
+# the header has no DIMENSION, reading it used to never end
+printf 'NAME: bad\nTYPE: TSP\nCOMMENT: bad header\nDIMENSIONS 5\nEOF\n' > "$TMP/bad.tsp"
+expect "malformed instance file" \
+	"{\"id\":5,\"instance\":\"$TMP/bad.tsp\"}" \
+	'"id":5,"status":"error"'
+
+printf 'NAME: short\nTYPE: TSP\nDIMENSION: 5\nEDGE_WEIGHT_TYPE: EUC_2D\nNODE_COORD_SECTION\n1 0 0\n2 3 4\nEOF\n' > "$TMP/short.tsp"
+expect "truncated instance file" \
+	"{\"id\":6,\"instance\":\"$TMP/short.tsp\"}" \
+	'"id":6,"status":"error"'
+
+# a table of 2^30 subsets used to end the server with std::bad_alloc
+expect "exact_max above the widest table" \
+	'{"id":7,"instance":"instances/burma14.tsp","exact_max":30}' \
+	'"id":7,"status":"error","error":"\"exact_max\" must be at most 24"'
+
+exit $status